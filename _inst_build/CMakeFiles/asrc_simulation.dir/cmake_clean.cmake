@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/asrc_simulation.dir/examples/asrc_simulation.cpp.o"
+  "CMakeFiles/asrc_simulation.dir/examples/asrc_simulation.cpp.o.d"
+  "asrc_simulation"
+  "asrc_simulation.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/asrc_simulation.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,27 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/src/cascade_resampler.cpp" "CMakeFiles/resampler.dir/src/cascade_resampler.cpp.o" "gcc" "CMakeFiles/resampler.dir/src/cascade_resampler.cpp.o.d"
+  "/root/repo/src/halfband_resampler.cpp" "CMakeFiles/resampler.dir/src/halfband_resampler.cpp.o" "gcc" "CMakeFiles/resampler.dir/src/halfband_resampler.cpp.o.d"
+  "/root/repo/src/preset_resampler.cpp" "CMakeFiles/resampler.dir/src/preset_resampler.cpp.o" "gcc" "CMakeFiles/resampler.dir/src/preset_resampler.cpp.o.d"
+  "/root/repo/src/resampler_drift.cpp" "CMakeFiles/resampler.dir/src/resampler_drift.cpp.o" "gcc" "CMakeFiles/resampler.dir/src/resampler_drift.cpp.o.d"
+  "/root/repo/src/resampler_kernel.cpp" "CMakeFiles/resampler.dir/src/resampler_kernel.cpp.o" "gcc" "CMakeFiles/resampler.dir/src/resampler_kernel.cpp.o.d"
+  "/root/repo/src/resampler_math.cpp" "CMakeFiles/resampler.dir/src/resampler_math.cpp.o" "gcc" "CMakeFiles/resampler.dir/src/resampler_math.cpp.o.d"
+  "/root/repo/src/resampler_ring.cpp" "CMakeFiles/resampler.dir/src/resampler_ring.cpp.o" "gcc" "CMakeFiles/resampler.dir/src/resampler_ring.cpp.o.d"
+  "/root/repo/src/resampler_simd.cpp" "CMakeFiles/resampler.dir/src/resampler_simd.cpp.o" "gcc" "CMakeFiles/resampler.dir/src/resampler_simd.cpp.o.d"
+  "/root/repo/src/resampler_stats.cpp" "CMakeFiles/resampler.dir/src/resampler_stats.cpp.o" "gcc" "CMakeFiles/resampler.dir/src/resampler_stats.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
@@ -0,0 +1,27 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/resampler.dir/src/cascade_resampler.cpp.o"
+  "CMakeFiles/resampler.dir/src/cascade_resampler.cpp.o.d"
+  "CMakeFiles/resampler.dir/src/halfband_resampler.cpp.o"
+  "CMakeFiles/resampler.dir/src/halfband_resampler.cpp.o.d"
+  "CMakeFiles/resampler.dir/src/preset_resampler.cpp.o"
+  "CMakeFiles/resampler.dir/src/preset_resampler.cpp.o.d"
+  "CMakeFiles/resampler.dir/src/resampler_drift.cpp.o"
+  "CMakeFiles/resampler.dir/src/resampler_drift.cpp.o.d"
+  "CMakeFiles/resampler.dir/src/resampler_kernel.cpp.o"
+  "CMakeFiles/resampler.dir/src/resampler_kernel.cpp.o.d"
+  "CMakeFiles/resampler.dir/src/resampler_math.cpp.o"
+  "CMakeFiles/resampler.dir/src/resampler_math.cpp.o.d"
+  "CMakeFiles/resampler.dir/src/resampler_ring.cpp.o"
+  "CMakeFiles/resampler.dir/src/resampler_ring.cpp.o.d"
+  "CMakeFiles/resampler.dir/src/resampler_simd.cpp.o"
+  "CMakeFiles/resampler.dir/src/resampler_simd.cpp.o.d"
+  "CMakeFiles/resampler.dir/src/resampler_stats.cpp.o"
+  "CMakeFiles/resampler.dir/src/resampler_stats.cpp.o.d"
+  "libresampler.a"
+  "libresampler.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/resampler.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
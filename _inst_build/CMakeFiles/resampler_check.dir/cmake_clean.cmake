@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/resampler_check.dir/examples/resampler_check.cpp.o"
+  "CMakeFiles/resampler_check.dir/examples/resampler_check.cpp.o.d"
+  "resampler_check"
+  "resampler_check.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/resampler_check.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/resampler_quality.dir/examples/resampler_quality.cpp.o"
+  "CMakeFiles/resampler_quality.dir/examples/resampler_quality.cpp.o.d"
+  "resampler_quality"
+  "resampler_quality.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/resampler_quality.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,160 @@
+#include "async_resampler.h"
+#include "resampler_ring.h"
+#include <getopt.h>
+#include <algorithm>
+#include <vector>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+/**
+   Simulation of a bridge between two devices with independent clocks
+
+   The producer writes blocks into a FIFO at its own clock, and the consumer
+   resamples blocks out of it at another clock. Clocks deviate from their
+   nominal rates by a few ppm, and the resampler compensates the drift to
+   keep the FIFO at its target fill level.
+ */
+struct SimulationOptions {
+    double inRate = 48000;
+    double outRate = 48000;
+    double inPpm = 100;
+    double outPpm = -50;
+    size_t inBlock = 256;
+    size_t outBlock = 480;
+    double targetFill = 1024;
+    double bandwidth = 0.05;
+    double seconds = 300;
+};
+
+static SimulationOptions sOptions;
+
+int main(int argc, char *argv[])
+{
+    for (int c; (c = getopt(argc, argv, "i:o:p:q:b:B:f:w:t:")) != -1;) {
+        switch (c) {
+        case 'i':
+            sOptions.inRate = atof(optarg);
+            break;
+        case 'o':
+            sOptions.outRate = atof(optarg);
+            break;
+        case 'p':
+            sOptions.inPpm = atof(optarg);
+            break;
+        case 'q':
+            sOptions.outPpm = atof(optarg);
+            break;
+        case 'b':
+            sOptions.inBlock = (size_t)atol(optarg);
+            break;
+        case 'B':
+            sOptions.outBlock = (size_t)atol(optarg);
+            break;
+        case 'f':
+            sOptions.targetFill = atof(optarg);
+            break;
+        case 'w':
+            sOptions.bandwidth = atof(optarg);
+            break;
+        case 't':
+            sOptions.seconds = atof(optarg);
+            break;
+        default:
+            fprintf(stderr,
+                    "Usage: asrc_simulation [-i input-rate] [-o output-rate]"
+                    " [-p input-ppm] [-q output-ppm] [-b input-block] [-B output-block]"
+                    " [-f target-fill] [-w bandwidth] [-t seconds]\n");
+            return 1;
+        }
+    }
+
+    if (sOptions.inRate <= 0 || sOptions.outRate <= 0 || sOptions.inBlock == 0 || sOptions.outBlock == 0) {
+        fprintf(stderr, "Invalid options.\n");
+        return 1;
+    }
+
+    // actual rates of the clocks
+    const double inClock = sOptions.inRate * (1 + 1e-6 * sOptions.inPpm);
+    const double outClock = sOptions.outRate * (1 + 1e-6 * sOptions.outPpm);
+
+    AsyncResampler<> rsm(1);
+    rsm.setup(sOptions.outRate / sOptions.inRate, sOptions.inRate, sOptions.targetFill);
+    rsm.controller().setup(rsm.ratio(), sOptions.inRate, sOptions.targetFill, sOptions.bandwidth);
+
+    // FIFO of input frames, starting at the target fill with silence
+    ResamplerRingBuffer fifo(1, 4 * ((size_t)sOptions.targetFill + sOptions.inBlock + sOptions.outBlock));
+    std::vector<float> in(sOptions.inBlock);
+    std::vector<float> out(sOptions.outBlock);
+    std::vector<float> silence((size_t)sOptions.targetFill);
+    fifo.write(silence.data(), silence.size());
+
+    double lastWrite = 0;
+    uint64_t inBlocks = 0;
+    uint64_t outBlocks = 0;
+    uint64_t inFrames = 0;
+    uint64_t underruns = 0;
+    uint64_t overruns = 0;
+    double nextReport = 0;
+    size_t minFill = SIZE_MAX;
+    size_t maxFill = 0;
+
+    printf("[");
+    bool first = true;
+
+    for (;;) {
+        double inTime = inBlocks * sOptions.inBlock / inClock;
+        double outTime = outBlocks * sOptions.outBlock / outClock;
+        double time = std::min(inTime, outTime);
+        if (time >= sOptions.seconds)
+            break;
+
+        if (inTime <= outTime) {
+            // producer: a tone at its nominal rate
+            for (size_t i = 0; i < sOptions.inBlock; ++i, ++inFrames)
+                in[i] = 0.5f * (float)std::sin(2 * M_PI * 1000 * inFrames / sOptions.inRate);
+            if (fifo.write(in.data(), in.size()) < in.size())
+                ++overruns;
+            lastWrite = inTime;
+            ++inBlocks;
+            continue;
+        }
+
+        // consumer
+        size_t fill = fifo.readable();
+        minFill = std::min(minFill, fill);
+        maxFill = std::max(maxFill, fill);
+
+        // extrapolate the level from the time of the last write, so it does
+        // not jump by blocks
+        double level = fill + (time - lastWrite) * sOptions.inRate - 0.5 * sOptions.inBlock;
+        rsm.track(level, sOptions.outBlock);
+        ResamplerCount count = resampleFromRing(rsm, fifo, out.data(), sOptions.outBlock);
+        if (count.produced < sOptions.outBlock)
+            ++underruns;
+        ++outBlocks;
+
+        if (time >= nextReport) {
+            const ResamplerDriftController &ctl = rsm.controller();
+            printf("%s\n  {\"time\": %.3f, \"fill\": %zu, \"smoothed_fill\": %.2f, "
+                   "\"ratio\": %.9f, \"drift_ppm\": %.3f, \"underruns\": %llu}",
+                   first ? "" : ",", time, fill, ctl.fill(),
+                   rsm.ratio(), 1e6 * ctl.drift(), (unsigned long long)underruns);
+            first = false;
+            nextReport += 1;
+        }
+    }
+
+    printf("\n]\n");
+
+    const double expected = (1e-6 * sOptions.inPpm - 1e-6 * sOptions.outPpm) / (1 + 1e-6 * sOptions.outPpm);
+    fprintf(stderr,
+            "drift: expected %.3f ppm, estimated %.3f ppm\n"
+            "fill: target %.0f, range [%zu:%zu]\n"
+            "underruns: %llu, overruns: %llu\n",
+            1e6 * expected, 1e6 * rsm.controller().drift(),
+            sOptions.targetFill, minFill, maxFill,
+            (unsigned long long)underruns, (unsigned long long)overruns);
+
+    return 0;
+}
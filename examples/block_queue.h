@@ -0,0 +1,35 @@
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+/**
+   Blocking queue of pointers, for passing buffers between threads
+
+   Buffers are preallocated in fixed number and circulate between a queue of
+   free buffers and a queue of filled buffers, which bounds the memory.
+ */
+template <class T>
+class BlockQueue {
+public:
+    void push(T *item)
+    {
+        std::lock_guard<std::mutex> lock(fMutex);
+        fItems.push_back(item);
+        fCond.notify_one();
+    }
+
+    T *pop()
+    {
+        std::unique_lock<std::mutex> lock(fMutex);
+        fCond.wait(lock, [this]() { return !fItems.empty(); });
+        T *item = fItems.front();
+        fItems.pop_front();
+        return item;
+    }
+
+private:
+    std::mutex fMutex;
+    std::condition_variable fCond;
+    std::deque<T *> fItems;
+};
@@ -1,5 +1,5 @@
 #include "file_resamplers.h"
-#include "resampler.h"
+#include "parallel_resampler.h"
 #include <soxr.h>
 #include <samplerate.h>
 #include <speex/speex_resampler.h>
@@ -10,56 +10,13 @@ void resample_with_mine(
     float *out, size_t out_frames,
     unsigned channels)
 {
-    double ratio = output_rate / input_rate;
-    uint32_t i_in = 0;
-    uint32_t i_out = 0;
-    auto getNextFrame = [&i_in, in, in_frames, channels](float *frame) {
-        if (i_in < in_frames) {
-            for (uint32_t c = 0; c < channels; ++c)
-                frame[c] = in[c + i_in * channels];
-            ++i_in;
-        }
-        else {
-            for (uint32_t c = 0; c < channels; ++c)
-                frame[c] = 0;
-        }
-    };
-    auto putNextFrame = [&i_out, out, channels](const float *frame) {
-        for (uint32_t c = 0; c < channels; ++c)
-            out[c + i_out * channels] = frame[c];
-        ++i_out;
-    };
-
-    ///
-    switch (channels) {
-    default:
-        fprintf(stderr, "Unsupported number of audio channels: %u\n", channels);
-        break;
-    case 1: {
-        Resampler<1> rsm;
-        rsm.setup(ratio);
-        rsm.resample(getNextFrame, putNextFrame, out_frames);
-        break;
-    }
-    case 2: {
-        Resampler<2> rsm;
-        rsm.setup(ratio);
-        rsm.resample(getNextFrame, putNextFrame, out_frames);
-        break;
-    }
-    case 4: {
-        Resampler<4> rsm;
-        rsm.setup(ratio);
-        rsm.resample(getNextFrame, putNextFrame, out_frames);
-        break;
-    }
-    case 8: {
-        Resampler<8> rsm;
-        rsm.setup(ratio);
-        rsm.resample(getNextFrame, putNextFrame, out_frames);
-        break;
-    }
-    }
+    DynamicResampler<> rsm(channels);
+    if (input_rate == (uint32_t)input_rate && output_rate == (uint32_t)output_rate)
+        rsm.setupRational((uint32_t)input_rate, (uint32_t)output_rate);
+    else
+        rsm.setup(output_rate / input_rate);
+
+    resampleParallel(rsm, in, in_frames, out, out_frames);
 }
 
 static void resample_with_sox(
@@ -248,3 +205,270 @@ void resample_with_linear(
         }
     }
 }
+
+//------------------------------------------------------------------------------
+// Streaming
+
+class StreamResamplerMine : public StreamResampler {
+public:
+    StreamResamplerMine(double input_rate, double output_rate, unsigned channels)
+        : fResampler(channels)
+    {
+        if (input_rate == (uint32_t)input_rate && output_rate == (uint32_t)output_rate)
+            fResampler.setupRational((uint32_t)input_rate, (uint32_t)output_rate);
+        else
+            fResampler.setup(output_rate / input_rate);
+        fRatio = output_rate / input_rate;
+    }
+
+    void process(const float *in, size_t in_frames, std::vector<float> &out) override
+    {
+        unsigned channels = fResampler.channels();
+        size_t i_in = 0;
+        while (i_in < in_frames) {
+            size_t capacity = (size_t)std::ceil((in_frames - i_in) * fRatio) + 1;
+            size_t i_out = out.size() / channels;
+            out.resize((i_out + capacity) * channels);
+            ResamplerCount count = fResampler.process(
+                in + i_in * channels, in_frames - i_in,
+                out.data() + i_out * channels, capacity);
+            out.resize((i_out + count.produced) * channels);
+            i_in += count.consumed;
+        }
+    }
+
+private:
+    DynamicResampler<> fResampler;
+    double fRatio = 1;
+};
+
+StreamResampler *create_stream_mine(double input_rate, double output_rate, unsigned channels)
+{
+    return new StreamResamplerMine(input_rate, output_rate, channels);
+}
+
+class StreamResamplerSox : public StreamResampler {
+public:
+    StreamResamplerSox(soxr_quality_spec_t quality_spec, double input_rate, double output_rate, unsigned channels)
+        : fChannels(channels), fRatio(output_rate / input_rate)
+    {
+        soxr_io_spec_t io_spec = soxr_io_spec(SOXR_FLOAT32_I, SOXR_FLOAT32_I);
+        soxr_runtime_spec_t runtime_spec = soxr_runtime_spec(1);
+        soxr_error_t err = nullptr;
+        fSoxr = soxr_create(input_rate, output_rate, channels, &err, &io_spec, &quality_spec, &runtime_spec);
+        if (err)
+            fprintf(stderr, "Error from SoX resampler: %s\n", err);
+    }
+
+    ~StreamResamplerSox()
+    {
+        if (fSoxr)
+            soxr_delete(fSoxr);
+    }
+
+    void process(const float *in, size_t in_frames, std::vector<float> &out) override
+    {
+        if (!fSoxr)
+            return;
+        size_t i_in = 0;
+        do {
+            size_t capacity = (size_t)std::ceil((in_frames - i_in) * fRatio) + 64;
+            size_t i_out = out.size() / fChannels;
+            out.resize((i_out + capacity) * fChannels);
+            size_t idone = 0;
+            size_t odone = 0;
+            soxr_error_t err = soxr_process(
+                fSoxr, in + i_in * fChannels, in_frames - i_in, &idone,
+                out.data() + i_out * fChannels, capacity, &odone);
+            out.resize((i_out + odone) * fChannels);
+            if (err) {
+                fprintf(stderr, "Error from SoX resampler: %s\n", err);
+                return;
+            }
+            i_in += idone;
+            if (idone == 0 && odone == 0)
+                break;
+        } while (i_in < in_frames);
+    }
+
+private:
+    soxr_t fSoxr = nullptr;
+    unsigned fChannels = 0;
+    double fRatio = 1;
+};
+
+StreamResampler *create_stream_sox_vhq(double input_rate, double output_rate, unsigned channels)
+{
+    return new StreamResamplerSox(soxr_quality_spec(SOXR_VHQ, 0), input_rate, output_rate, channels);
+}
+
+StreamResampler *create_stream_sox_mq(double input_rate, double output_rate, unsigned channels)
+{
+    return new StreamResamplerSox(soxr_quality_spec(SOXR_MQ, 0), input_rate, output_rate, channels);
+}
+
+StreamResampler *create_stream_sox_lq(double input_rate, double output_rate, unsigned channels)
+{
+    return new StreamResamplerSox(soxr_quality_spec(SOXR_LQ, 0), input_rate, output_rate, channels);
+}
+
+class StreamResamplerSrc : public StreamResampler {
+public:
+    StreamResamplerSrc(int converter_type, double input_rate, double output_rate, unsigned channels)
+        : fChannels(channels), fRatio(output_rate / input_rate)
+    {
+        int err = 0;
+        fState = src_new(converter_type, channels, &err);
+        if (!fState)
+            fprintf(stderr, "Error from Secret Rabbit Code resampler: %s\n", src_strerror(err));
+    }
+
+    ~StreamResamplerSrc()
+    {
+        if (fState)
+            src_delete(fState);
+    }
+
+    void process(const float *in, size_t in_frames, std::vector<float> &out) override
+    {
+        if (!fState)
+            return;
+        size_t i_in = 0;
+        do {
+            size_t capacity = (size_t)std::ceil((in_frames - i_in) * fRatio) + 64;
+            size_t i_out = out.size() / fChannels;
+            out.resize((i_out + capacity) * fChannels);
+            SRC_DATA src_data = {};
+            src_data.data_in = in + i_in * fChannels;
+            src_data.data_out = out.data() + i_out * fChannels;
+            src_data.input_frames = in_frames - i_in;
+            src_data.output_frames = capacity;
+            src_data.src_ratio = fRatio;
+            int err = src_process(fState, &src_data);
+            out.resize((i_out + src_data.output_frames_gen) * fChannels);
+            if (err != 0) {
+                fprintf(stderr, "Error from Secret Rabbit Code resampler: %s\n", src_strerror(err));
+                return;
+            }
+            i_in += src_data.input_frames_used;
+            if (src_data.input_frames_used == 0 && src_data.output_frames_gen == 0)
+                break;
+        } while (i_in < in_frames);
+    }
+
+private:
+    SRC_STATE *fState = nullptr;
+    unsigned fChannels = 0;
+    double fRatio = 1;
+};
+
+StreamResampler *create_stream_src_best(double input_rate, double output_rate, unsigned channels)
+{
+    return new StreamResamplerSrc(SRC_SINC_BEST_QUALITY, input_rate, output_rate, channels);
+}
+
+StreamResampler *create_stream_src_medium(double input_rate, double output_rate, unsigned channels)
+{
+    return new StreamResamplerSrc(SRC_SINC_MEDIUM_QUALITY, input_rate, output_rate, channels);
+}
+
+StreamResampler *create_stream_src_fastest(double input_rate, double output_rate, unsigned channels)
+{
+    return new StreamResamplerSrc(SRC_SINC_FASTEST, input_rate, output_rate, channels);
+}
+
+class StreamResamplerSpeex : public StreamResampler {
+public:
+    StreamResamplerSpeex(int quality, double input_rate, double output_rate, unsigned channels)
+        : fChannels(channels), fRatio(output_rate / input_rate)
+    {
+        int err = 0;
+        fState = speex_resampler_init(channels, input_rate, output_rate, quality, &err);
+        if (!fState)
+            fprintf(stderr, "Error from Speex resampler: %s\n", speex_resampler_strerror(err));
+        else
+            speex_resampler_skip_zeros(fState);
+    }
+
+    ~StreamResamplerSpeex()
+    {
+        if (fState)
+            speex_resampler_destroy(fState);
+    }
+
+    void process(const float *in, size_t in_frames, std::vector<float> &out) override
+    {
+        if (!fState)
+            return;
+        size_t i_in = 0;
+        do {
+            size_t capacity = (size_t)std::ceil((in_frames - i_in) * fRatio) + 64;
+            size_t i_out = out.size() / fChannels;
+            out.resize((i_out + capacity) * fChannels);
+            spx_uint32_t in_spx = in_frames - i_in;
+            spx_uint32_t out_spx = capacity;
+            speex_resampler_process_interleaved_float(
+                fState, in + i_in * fChannels, &in_spx,
+                out.data() + i_out * fChannels, &out_spx);
+            out.resize((i_out + out_spx) * fChannels);
+            i_in += in_spx;
+            if (in_spx == 0 && out_spx == 0)
+                break;
+        } while (i_in < in_frames);
+    }
+
+private:
+    SpeexResamplerState *fState = nullptr;
+    unsigned fChannels = 0;
+    double fRatio = 1;
+};
+
+StreamResampler *create_stream_speex_mq(double input_rate, double output_rate, unsigned channels)
+{
+    return new StreamResamplerSpeex(SPEEX_RESAMPLER_QUALITY_DEFAULT, input_rate, output_rate, channels);
+}
+
+StreamResampler *create_stream_speex_vhq(double input_rate, double output_rate, unsigned channels)
+{
+    return new StreamResamplerSpeex(SPEEX_RESAMPLER_QUALITY_MAX, input_rate, output_rate, channels);
+}
+
+class StreamResamplerLinear : public StreamResampler {
+public:
+    StreamResamplerLinear(double input_rate, double output_rate, unsigned channels)
+        : fChannels(channels), fIncr(input_rate / output_rate), fLast(channels)
+    {
+    }
+
+    void process(const float *in, size_t in_frames, std::vector<float> &out) override
+    {
+        // `fPos` is the next output position, relative to the frame `fLast`
+        while (fPos < in_frames) {
+            size_t index = (size_t)fPos;
+            double mu = fPos - index;
+            for (unsigned c = 0; c < fChannels; ++c) {
+                double sample1 = (index == 0) ? fLast[c] : in[c + fChannels * (index - 1)];
+                double sample2 = in[c + fChannels * index];
+                out.push_back(mu * sample2 + (1 - mu) * sample1);
+            }
+            fPos += fIncr;
+        }
+
+        fPos -= in_frames;
+        if (in_frames > 0) {
+            for (unsigned c = 0; c < fChannels; ++c)
+                fLast[c] = in[c + fChannels * (in_frames - 1)];
+        }
+    }
+
+private:
+    unsigned fChannels = 0;
+    double fIncr = 1;
+    double fPos = 1;
+    std::vector<float> fLast;
+};
+
+StreamResampler *create_stream_linear(double input_rate, double output_rate, unsigned channels)
+{
+    return new StreamResamplerLinear(input_rate, output_rate, channels);
+}
@@ -1,5 +1,6 @@
 #pragma once
 #include <array>
+#include <vector>
 #include <cstddef>
 
 void resample_with_mine(
@@ -68,20 +69,50 @@ typedef void (resample_file_t)(
     float *out, size_t out_frames,
     unsigned channels);
 
+/**
+   Resampler which processes a stream block by block
+ */
+class StreamResampler {
+public:
+    virtual ~StreamResampler() {}
+
+    /**
+       Resample a block of interleaved frames, consuming all of it.
+       The output frames are appended to `out`.
+     */
+    virtual void process(const float *in, size_t in_frames, std::vector<float> &out) = 0;
+};
+
+StreamResampler *create_stream_mine(double input_rate, double output_rate, unsigned channels);
+StreamResampler *create_stream_sox_vhq(double input_rate, double output_rate, unsigned channels);
+StreamResampler *create_stream_sox_mq(double input_rate, double output_rate, unsigned channels);
+StreamResampler *create_stream_sox_lq(double input_rate, double output_rate, unsigned channels);
+StreamResampler *create_stream_src_best(double input_rate, double output_rate, unsigned channels);
+StreamResampler *create_stream_src_medium(double input_rate, double output_rate, unsigned channels);
+StreamResampler *create_stream_src_fastest(double input_rate, double output_rate, unsigned channels);
+StreamResampler *create_stream_speex_mq(double input_rate, double output_rate, unsigned channels);
+StreamResampler *create_stream_speex_vhq(double input_rate, double output_rate, unsigned channels);
+StreamResampler *create_stream_linear(double input_rate, double output_rate, unsigned channels);
+
+typedef StreamResampler *(create_stream_t)(
+    double input_rate, double output_rate,
+    unsigned channels);
+
 struct ResamplingChoice {
     const char *name;
     resample_file_t *resample;
+    create_stream_t *create_stream;
 };
 
 static std::array<ResamplingChoice, 10> sResamplingChoices {{
-    {"mine", &resample_with_mine},
-    {"soxvhq", &resample_with_sox_vhq},
-    {"soxmq", &resample_with_sox_mq},
-    {"soxlq", &resample_with_sox_lq},
-    {"srcvhq", &resample_with_src_best},
-    {"srcmq", &resample_with_src_medium},
-    {"srclq", &resample_with_src_fastest},
-    {"speexmq", &resample_with_speex_mq},
-    {"speexvhq", &resample_with_speex_vhq},
-    {"linear", &resample_with_linear},
+    {"mine", &resample_with_mine, &create_stream_mine},
+    {"soxvhq", &resample_with_sox_vhq, &create_stream_sox_vhq},
+    {"soxmq", &resample_with_sox_mq, &create_stream_sox_mq},
+    {"soxlq", &resample_with_sox_lq, &create_stream_sox_lq},
+    {"srcvhq", &resample_with_src_best, &create_stream_src_best},
+    {"srcmq", &resample_with_src_medium, &create_stream_src_medium},
+    {"srclq", &resample_with_src_fastest, &create_stream_src_fastest},
+    {"speexmq", &resample_with_speex_mq, &create_stream_speex_mq},
+    {"speexvhq", &resample_with_speex_vhq, &create_stream_speex_vhq},
+    {"linear", &resample_with_linear, &create_stream_linear},
 }};
@@ -1,12 +1,34 @@
 #include "file_resamplers.h"
+#include "block_queue.h"
 #include <sndfile.hh>
 #include <getopt.h>
 #include <memory>
+#include <thread>
+#include <vector>
 #include <cmath>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
 
+// number of input frames per block
+static constexpr size_t block_frames = 4096;
+
+// number of buffers circulating between each pair of pipeline stages
+static constexpr size_t num_buffers = 3;
+
+// maximum number of silent blocks past the end of input
+static constexpr size_t max_padding_blocks = 64;
+
+struct InputBlock {
+    std::vector<float> data;
+    size_t frames = 0;
+};
+
+struct OutputBlock {
+    // output of each resampling choice, with its own number of frames
+    std::vector<std::vector<float>> data;
+};
+
 int main(int argc, char *argv[])
 {
     const char *in_path = nullptr;
@@ -54,13 +76,13 @@ int main(int argc, char *argv[])
     size_t in_frames = snd_in.frames();
     size_t out_frames = (size_t)std::ceil(in_frames * ratio);
 
-    float *in = new float[in_frames * channels]{};
-    snd_in.readf(in, in_frames);
-
     int exitcode = 0;
 
-    #pragma omp parallel for
-    for (size_t i = 0; i < sResamplingChoices.size(); ++i) {
+    const size_t num_choices = sResamplingChoices.size();
+    std::vector<SndfileHandle> snd_outs(num_choices);
+    std::vector<std::unique_ptr<StreamResampler>> streams(num_choices);
+
+    for (size_t i = 0; i < num_choices; ++i) {
         const ResamplingChoice &rc = sResamplingChoices[i];
 
         std::string this_out_path = out_path;
@@ -83,20 +105,100 @@ int main(int argc, char *argv[])
 
         SndfileHandle snd_out{this_out_path.c_str(), SFM_WRITE, SF_FORMAT_WAV|SF_FORMAT_PCM_16, (int)channels, (int)samplerate};
         if (!snd_out) {
-            fprintf(stderr, "Cannot open the output file: %s.\n", out_path);
+            fprintf(stderr, "Cannot open the output file: %s.\n", this_out_path.c_str());
             exitcode = 1;
-
         }
         else {
-            float *out = new float[out_frames * channels]{};
+            snd_outs[i] = snd_out;
+            streams[i].reset(rc.create_stream(samplerate, ratio * samplerate, channels));
+        }
+    }
 
-            rc.resample(
-                samplerate, ratio * samplerate,
-                in, in_frames, out, out_frames, channels);
+    ///
+    std::vector<InputBlock> in_blocks(num_buffers);
+    std::vector<OutputBlock> out_blocks(num_buffers);
+    BlockQueue<InputBlock> free_in, filled_in;
+    BlockQueue<OutputBlock> free_out, filled_out;
 
-            snd_out.writef(out, out_frames);
+    for (InputBlock &block : in_blocks) {
+        block.data.resize(block_frames * channels);
+        free_in.push(&block);
+    }
+    for (OutputBlock &block : out_blocks) {
+        block.data.resize(num_choices);
+        free_out.push(&block);
+    }
+
+    // reader: fill input blocks from the file, then signal the end
+    std::thread reader([&]() {
+        for (;;) {
+            InputBlock *block = free_in.pop();
+            block->frames = snd_in.readf(block->data.data(), block_frames);
+            if (block->frames == 0) {
+                free_in.push(block);
+                filled_in.push(nullptr);
+                break;
+            }
+            filled_in.push(block);
+        }
+    });
+
+    // writer: write output blocks to the files, until the end
+    std::thread writer([&]() {
+        while (OutputBlock *block = filled_out.pop()) {
+            for (size_t i = 0; i < num_choices; ++i) {
+                const std::vector<float> &data = block->data[i];
+                if (streams[i] && !data.empty())
+                    snd_outs[i].writef(data.data(), data.size() / channels);
+            }
+            free_out.push(block);
+        }
+    });
+
+    // resampler: past the end of input, continue with silence until all the
+    // output frames are produced
+    std::vector<size_t> written(num_choices);
+    const std::vector<float> silence(block_frames * channels);
+    bool input_ended = false;
+    size_t padding_blocks = 0;
+
+    for (;;) {
+        InputBlock *in_block = nullptr;
+        if (!input_ended) {
+            in_block = filled_in.pop();
+            input_ended = in_block == nullptr;
         }
+
+        const float *in = in_block ? in_block->data.data() : silence.data();
+        size_t frames = in_block ? in_block->frames : block_frames;
+
+        OutputBlock *out_block = free_out.pop();
+        bool done = true;
+
+        #pragma omp parallel for reduction(&&:done)
+        for (size_t i = 0; i < num_choices; ++i) {
+            std::vector<float> &data = out_block->data[i];
+            data.clear();
+            if (!streams[i] || written[i] >= out_frames)
+                continue;
+            streams[i]->process(in, frames, data);
+            size_t count = std::min(data.size() / channels, out_frames - written[i]);
+            data.resize(count * channels);
+            written[i] += count;
+            done = done && written[i] >= out_frames;
+        }
+
+        if (in_block)
+            free_in.push(in_block);
+        filled_out.push(out_block);
+
+        if (input_ended && (done || ++padding_blocks > max_padding_blocks))
+            break;
     }
 
+    filled_out.push(nullptr);
+    reader.join();
+    writer.join();
+
     return exitcode;
 }
@@ -0,0 +1,348 @@
+#include "resampler.h"
+#include "cascade_resampler.h"
+#include "multistream_resampler.h"
+#include "resampler_simd.h"
+#if defined(HAVE_FILE_RESAMPLERS)
+#include "file_resamplers.h"
+#endif
+#include <getopt.h>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HAVE_RDTSC 1
+#endif
+
+struct BenchRate {
+    uint32_t in;
+    uint32_t out;
+};
+
+static const BenchRate sRates[] = {
+    {44100, 48000},
+    {48000, 44100},
+    {48000, 16000},
+    {16000, 48000},
+    {44100, 96000},
+    {96000, 48000},
+    {192000, 44100},
+    {8000, 48000},
+};
+
+enum class BenchMode {
+    Table,
+    Interpolated,
+    Rational,
+    Float16,
+    BFloat16,
+    Folded16,
+};
+
+static const char *modeName(BenchMode mode)
+{
+    switch (mode) {
+    case BenchMode::Table:
+        return "table";
+    case BenchMode::Interpolated:
+        return "interpolated";
+    case BenchMode::Rational:
+        return "rational";
+    case BenchMode::Float16:
+        return "float16";
+    case BenchMode::BFloat16:
+        return "bfloat16";
+    case BenchMode::Folded16:
+        return "folded16";
+    default:
+        return "unknown";
+    }
+}
+
+struct BenchResult {
+    double seconds = 0;
+    uint64_t cycles = 0;
+    size_t frames = 0;
+};
+
+struct BenchOptions {
+    size_t frames = 1 << 18;
+    int repeats = 3;
+};
+
+static BenchOptions sOptions;
+
+/**
+   Counters of the resamplers, in the builds with the instrumentation
+ */
+static ResamplerStatsRegistry sStats;
+
+static uint64_t readCycles()
+{
+#if defined(HAVE_RDTSC)
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+/**
+   Run the function several times, and keep the fastest run.
+   The function returns the number of output frames it has computed.
+ */
+template <class F>
+static BenchResult measure(const F &run)
+{
+    BenchResult best;
+    for (int r = 0; r < sOptions.repeats; ++r) {
+        auto t0 = std::chrono::steady_clock::now();
+        uint64_t c0 = readCycles();
+        size_t frames = run();
+        uint64_t c1 = readCycles();
+        auto t1 = std::chrono::steady_clock::now();
+        double seconds = std::chrono::duration<double>(t1 - t0).count();
+        if (r == 0 || seconds < best.seconds) {
+            best.seconds = seconds;
+            best.cycles = c1 - c0;
+            best.frames = frames;
+        }
+    }
+    return best;
+}
+
+static std::vector<float> makeInput(size_t frames, unsigned channels)
+{
+    std::vector<float> input(frames * channels);
+    std::minstd_rand prng;
+    std::uniform_real_distribution<float> dist(-0.5f, 0.5f);
+    for (float &x : input)
+        x = dist(prng);
+    return input;
+}
+
+static void printResult(
+    const char *engine, const char *mode, unsigned channels,
+    uint32_t ksize, uint32_t ktable, size_t kernelBytes,
+    const BenchRate &rate, const BenchResult &result)
+{
+    static bool first = true;
+    printf("%s\n  {\"engine\": \"%s\", \"mode\": \"%s\", \"isa\": \"%s\", "
+           "\"channels\": %u, \"ksize\": %u, \"ktable\": %u, \"kernel_bytes\": %zu, "
+           "\"in_rate\": %u, \"out_rate\": %u, \"out_frames\": %zu, "
+           "\"seconds\": %.6f, \"frames_per_second\": %.1f, ",
+           first ? "" : ",", engine, mode,
+           ResamplerSIMD::isaName(ResamplerSIMD::functions().isa),
+           channels, ksize, ktable, kernelBytes, rate.in, rate.out,
+           result.frames, result.seconds, result.frames / result.seconds);
+#if defined(HAVE_RDTSC)
+    printf("\"cycles_per_frame\": %.2f}", (double)result.cycles / result.frames);
+#else
+    printf("\"cycles_per_frame\": null}");
+#endif
+    first = false;
+    fflush(stdout);
+}
+
+template <uint32_t Nch, uint32_t Ksize, uint32_t Ktable>
+static void benchMine(BenchMode mode, const BenchRate &rate)
+{
+    const std::vector<float> input = makeInput(sOptions.frames, Nch);
+    const size_t outFrames = (size_t)std::ceil(sOptions.frames * (double)rate.out / rate.in);
+    std::vector<float> output(outFrames * Nch);
+
+    Resampler<Nch, Ksize, Ktable> rsm;
+    if (mode == BenchMode::Rational) {
+        if (!rsm.setupRational(rate.in, rate.out))
+            return;
+    }
+    else {
+        rsm.setup((double)rate.out / rate.in);
+        rsm.core().setInterpolated(mode == BenchMode::Interpolated);
+    }
+
+    if (mode == BenchMode::Float16 || mode == BenchMode::Folded16)
+        rsm.core().setStorage(ResamplerFormat::Float16, mode == BenchMode::Folded16);
+    else if (mode == BenchMode::BFloat16)
+        rsm.core().setStorage(ResamplerFormat::BFloat16);
+
+    auto run = [&]() -> size_t {
+        rsm.clear();
+        ResamplerCount count = rsm.process(input.data(), sOptions.frames, output.data(), outFrames);
+        return count.produced;
+    };
+
+    run(); // warm up
+    BenchResult result = measure(run);
+    printResult("mine", modeName(mode), Nch, Ksize, Ktable, rsm.core().kernelBytes(), rate, result);
+
+    char label[128];
+    snprintf(label, sizeof(label), "%s, %u channels, %u taps, %u->%u",
+             modeName(mode), Nch, Ksize, rate.in, rate.out);
+    sStats.add(label, rsm.stats());
+}
+
+template <uint32_t Nch, uint32_t Ksize, uint32_t Ktable>
+static void benchMineInt16(const BenchRate &rate)
+{
+    const std::vector<float> source = makeInput(sOptions.frames, Nch);
+    const size_t outFrames = (size_t)std::ceil(sOptions.frames * (double)rate.out / rate.in);
+    std::vector<int16_t> input(source.size());
+    std::vector<int16_t> output(outFrames * Nch);
+
+    for (size_t i = 0; i < source.size(); ++i)
+        input[i] = (int16_t)std::lrint(source[i] * 32767);
+
+    Resampler<Nch, Ksize, Ktable> rsm;
+    if (!rsm.setupRational(rate.in, rate.out))
+        return;
+
+    auto run = [&]() -> size_t {
+        rsm.clear();
+        ResamplerCount count = rsm.process(input.data(), sOptions.frames, output.data(), outFrames);
+        return count.produced;
+    };
+
+    run(); // warm up
+    BenchResult result = measure(run);
+    printResult("mine", "int16", Nch, Ksize, Ktable, rsm.core().kernelBytes() / 2, rate, result);
+}
+
+template <uint32_t Ksize>
+static void benchStreams(uint32_t streams, const BenchRate &rate)
+{
+    const size_t inFrames = sOptions.frames / 16;
+    const size_t outFrames = (size_t)std::ceil(inFrames * (double)rate.out / rate.in);
+    const std::vector<float> input = makeInput(inFrames, streams);
+    std::vector<float> output(outFrames * streams);
+    std::vector<ResamplerCount> counts(streams);
+
+    std::vector<const float *> in(streams);
+    std::vector<float *> out(streams);
+    for (uint32_t s = 0; s < streams; ++s) {
+        in[s] = &input[s * inFrames];
+        out[s] = &output[s * outFrames];
+    }
+
+    MultiStreamResampler<Ksize> rsm(streams);
+    if (!rsm.setupRational(rate.in, rate.out))
+        return;
+
+    auto run = [&]() -> size_t {
+        rsm.clear();
+        rsm.process(in.data(), inFrames, out.data(), outFrames, counts.data());
+        return counts[0].produced;
+    };
+
+    run(); // warm up
+    BenchResult result = measure(run);
+    printResult("mine", "streams", streams, Ksize, 128 * 1024, 0, rate, result);
+}
+
+template <uint32_t Nch>
+static void benchCascade(const BenchRate &rate)
+{
+    const std::vector<float> input = makeInput(sOptions.frames, Nch);
+    const size_t outFrames = (size_t)std::ceil(sOptions.frames * (double)rate.out / rate.in);
+    std::vector<float> output(outFrames * Nch);
+
+    CascadeResampler rsm(Nch);
+    rsm.setup(rate.in, rate.out);
+
+    auto run = [&]() -> size_t {
+        rsm.clear();
+        ResamplerCount count = rsm.process(input.data(), sOptions.frames, output.data(), outFrames);
+        return count.produced;
+    };
+
+    run(); // warm up
+    BenchResult result = measure(run);
+    printResult("mine", "cascade", Nch, 0, 0, 0, rate, result);
+}
+
+template <uint32_t Nch>
+static void benchMineChannels()
+{
+    for (const BenchRate &rate : sRates) {
+        benchMine<Nch, 16, 128 * 1024>(BenchMode::Table, rate);
+        benchMine<Nch, 32, 128 * 1024>(BenchMode::Table, rate);
+        benchMine<Nch, 64, 128 * 1024>(BenchMode::Table, rate);
+        benchMine<Nch, 32, 128 * 1024>(BenchMode::Rational, rate);
+        benchMine<Nch, 32, 128 * 1024>(BenchMode::Float16, rate);
+        benchMine<Nch, 32, 128 * 1024>(BenchMode::BFloat16, rate);
+        benchMine<Nch, 32, 128 * 1024>(BenchMode::Folded16, rate);
+        benchMineInt16<Nch, 32, 128 * 1024>(rate);
+        benchMine<Nch, 32, 32 * 64>(BenchMode::Interpolated, rate);
+        benchMine<Nch, 32, 32 * 256>(BenchMode::Interpolated, rate);
+        benchCascade<Nch>(rate);
+    }
+}
+
+#if defined(HAVE_FILE_RESAMPLERS)
+static void benchChoice(const ResamplingChoice &rc, unsigned channels, const BenchRate &rate)
+{
+    const std::vector<float> input = makeInput(sOptions.frames, channels);
+    const size_t outFrames = (size_t)std::ceil(sOptions.frames * (double)rate.out / rate.in);
+    std::vector<float> output(outFrames * channels);
+
+    auto run = [&]() -> size_t {
+        rc.resample(rate.in, rate.out, input.data(), sOptions.frames, output.data(), outFrames, channels);
+        return outFrames;
+    };
+
+    run(); // warm up
+    BenchResult result = measure(run);
+    printResult(rc.name, "oneshot", channels, 0, 0, 0, rate, result);
+}
+#endif
+
+int main(int argc, char *argv[])
+{
+    for (int c; (c = getopt(argc, argv, "n:r:")) != -1;) {
+        switch (c) {
+        case 'n':
+            sOptions.frames = (size_t)atol(optarg);
+            break;
+        case 'r':
+            sOptions.repeats = atoi(optarg);
+            break;
+        default:
+            fprintf(stderr, "Usage: resampler_bench [-n input-frames] [-r repeats]\n");
+            return 1;
+        }
+    }
+
+    if (sOptions.frames == 0 || sOptions.repeats <= 0) {
+        fprintf(stderr, "Invalid options.\n");
+        return 1;
+    }
+
+    printf("[");
+
+    benchMineChannels<1>();
+    benchMineChannels<2>();
+    benchMineChannels<8>();
+
+    for (const BenchRate &rate : sRates)
+        benchStreams<32>(256, rate);
+
+#if defined(HAVE_FILE_RESAMPLERS)
+    for (const ResamplingChoice &rc : sResamplingChoices) {
+        if (rc.resample == &resample_with_mine)
+            continue;
+        for (unsigned channels : {1u, 2u, 8u}) {
+            for (const BenchRate &rate : sRates)
+                benchChoice(rc, channels, rate);
+        }
+    }
+#endif
+
+    printf("\n]\n");
+
+    if (ResamplerStats::enabled())
+        sStats.print(stderr);
+
+    return 0;
+}
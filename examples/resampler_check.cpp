@@ -0,0 +1,833 @@
+#include "async_resampler.h"
+#include "halfband_resampler.h"
+#include "multistream_resampler.h"
+#include "parallel_resampler.h"
+#include "preset_resampler.h"
+#include "resampler_math.h"
+#include "resampler_ring.h"
+#include "resampler_simd.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+#include <cstdio>
+#include <cstring>
+
+/**
+   Checks of the exactness guarantees of the resamplers, run by CTest
+
+   Every check prints the cases which fail, and the program exits with a
+   failure status if there are any.
+ */
+static unsigned sFailures = 0;
+
+static std::mt19937 sRandom(1);
+
+static void fail(const char *check, const char *what)
+{
+    printf("FAIL: %s: %s\n", check, what);
+    ++sFailures;
+}
+
+static std::vector<float> makeNoise(size_t count)
+{
+    std::uniform_real_distribution<float> dist(-1, 1);
+    std::vector<float> noise(count);
+    for (float &x : noise)
+        x = dist(sRandom);
+    return noise;
+}
+
+static bool sameBits(const float *a, const float *b, size_t count)
+{
+    return std::memcmp(a, b, count * sizeof(float)) == 0;
+}
+
+struct CheckRate {
+    uint32_t in;
+    uint32_t out;
+    bool rational;
+};
+
+static const CheckRate sRates[] = {
+    {16000, 48000, false},
+    {8000, 48000, false},
+    {44100, 48000, false},
+    {48000, 44100, false},
+    {44100, 96000, true},
+};
+
+static void setupRate(DynamicResampler<32> &rsm, const CheckRate &rate)
+{
+    if (rate.rational)
+        rsm.setupRational(rate.in, rate.out);
+    else
+        rsm.setup((double)rate.out / rate.in);
+}
+
+//------------------------------------------------------------------------------
+
+/**
+   The batched dot products are the same as the single ones, bit for bit.
+ */
+static void checkDot4()
+{
+    using namespace ResamplerSIMD;
+
+    for (Isa isa : {Isa::Scalar, Isa::SSE2, Isa::AVX2, Isa::AVX512, Isa::NEON}) {
+        const Functions *f = functions(isa);
+        if (!f)
+            continue;
+
+        for (uint32_t n = 1; n <= 130; ++n) {
+            std::vector<float> a = makeNoise(4 * n);
+            std::vector<float> b = makeNoise(n);
+            const float *rows[4] = {&a[0], &a[n], &a[2 * n], &a[3 * n]};
+
+            float r[4];
+            f->dot4(r, rows, b.data(), n);
+
+            for (uint32_t j = 0; j < 4; ++j) {
+                float single = f->dot(rows[j], b.data(), n);
+                if (!sameBits(&single, &r[j], 1)) {
+                    char what[128];
+                    snprintf(what, sizeof(what), "%s, n=%u", isaName(isa), n);
+                    fail("dot4 differs from dot", what);
+                    break;
+                }
+            }
+        }
+    }
+}
+
+/**
+   The symmetric, reversed and 16-bit dot products of every instruction set
+   agree with the scalar ones: within rounding for float, exactly for 16-bit.
+ */
+static void checkDotVariants()
+{
+    using namespace ResamplerSIMD;
+
+    const Functions *scalar = functions(Isa::Scalar);
+    std::uniform_int_distribution<int> dist16(-32768, 32767);
+
+    for (Isa isa : {Isa::SSE2, Isa::AVX2, Isa::AVX512, Isa::NEON}) {
+        const Functions *f = functions(isa);
+        if (!f)
+            continue;
+
+        for (uint32_t n = 1; n <= 130; ++n) {
+            char what[128];
+            snprintf(what, sizeof(what), "%s, n=%u", isaName(isa), n);
+
+            // exact sizes, so that any access out of range is caught by tools
+            std::vector<float> a = makeNoise(n);
+            std::vector<float> b = makeNoise(n);
+            std::vector<float> h = makeNoise(n);
+            float sym = f->dotSymmetric(a.data(), b.data(), h.data(), n);
+            float symScalar = scalar->dotSymmetric(a.data(), b.data(), h.data(), n);
+            if (std::fabs(sym - symScalar) > 1e-5f * 2 * n)
+                fail("dotSymmetric differs from scalar", what);
+
+            float rev = f->dotReversed(a.data(), b.data(), n);
+            float revScalar = scalar->dotReversed(a.data(), b.data(), n);
+            if (std::fabs(rev - revScalar) > 1e-5f * n)
+                fail("dotReversed differs from scalar", what);
+
+            std::vector<int16_t> a16(n);
+            std::vector<int16_t> b16(n);
+            for (uint32_t i = 0; i < n; ++i) {
+                a16[i] = (int16_t)dist16(sRandom);
+                b16[i] = (int16_t)dist16(sRandom);
+            }
+            if (f->dotInt16(a16.data(), b16.data(), n) != scalar->dotInt16(a16.data(), b16.data(), n))
+                fail("dotInt16 differs from scalar", what);
+        }
+    }
+}
+
+/**
+   The output does not depend on how the stream is divided into blocks, or
+   into parallel chunks.
+ */
+static void checkChunked()
+{
+    const size_t inFrames = 8192;
+
+    for (const CheckRate &rate : sRates) {
+        for (uint32_t nch : {1u, 2u, 8u}) {
+            for (bool interpolated : {false, true}) {
+                DynamicResampler<32> prototype(nch);
+                setupRate(prototype, rate);
+                prototype.core().setInterpolated(interpolated);
+
+                const size_t outFrames = (size_t)((uint64_t)inFrames * rate.out / rate.in);
+                std::vector<float> in = makeNoise(inFrames * nch);
+                std::vector<float> serial(outFrames * nch);
+                std::vector<float> chunked(outFrames * nch);
+                std::vector<float> blocks(outFrames * nch);
+
+                resampleParallel(prototype, in.data(), inFrames, serial.data(), outFrames, outFrames);
+                resampleParallel(prototype, in.data(), inFrames, chunked.data(), outFrames, 13);
+
+                // random blocks of input and output, which cut the batches
+                DynamicResampler<32> rsm(prototype);
+                size_t i_in = 0;
+                size_t i_out = 0;
+                while (i_in < inFrames && i_out < outFrames) {
+                    size_t inBlock = std::min<size_t>(1 + sRandom() % 100, inFrames - i_in);
+                    size_t outBlock = std::min<size_t>(1 + sRandom() % 7, outFrames - i_out);
+                    ResamplerCount count = rsm.process(
+                        &in[i_in * nch], inBlock, &blocks[i_out * nch], outBlock);
+                    i_in += count.consumed;
+                    i_out += count.produced;
+                }
+
+                char what[128];
+                snprintf(what, sizeof(what), "%u->%u%s, %u channels%s",
+                         rate.in, rate.out, rate.rational ? " rational" : "",
+                         nch, interpolated ? ", interpolated" : "");
+
+                if (!sameBits(serial.data(), chunked.data(), outFrames * nch))
+                    fail("chunks differ from serial", what);
+                if (!sameBits(serial.data(), blocks.data(), i_out * nch))
+                    fail("blocks differ from serial", what);
+            }
+        }
+    }
+}
+
+/**
+   The folded table gives the output of the full one, within rounding, on
+   every path: whole blocks and short ones, per channel and in lanes.
+ */
+static void checkFolded()
+{
+    const size_t inFrames = 4096;
+
+    for (const CheckRate &rate : sRates) {
+        for (uint32_t nch : {1u, 2u, 8u}) {
+            for (bool interpolated : {false, true}) {
+                for (size_t block : {inFrames, (size_t)5}) {
+                    const size_t outFrames = (size_t)((uint64_t)inFrames * rate.out / rate.in);
+                    std::vector<float> in = makeNoise(inFrames * nch);
+                    std::vector<float> out[2];
+
+                    for (bool folded : {false, true}) {
+                        DynamicResampler<32> rsm(nch);
+                        rsm.core().setInterpolated(interpolated);
+                        rsm.core().setStorage(ResamplerFormat::Float32, folded);
+                        setupRate(rsm, rate);
+
+                        std::vector<float> &o = out[folded];
+                        o.resize(outFrames * nch);
+                        size_t i_in = 0;
+                        size_t i_out = 0;
+                        while (i_in < inFrames && i_out < outFrames) {
+                            ResamplerCount count = rsm.process(
+                                &in[i_in * nch], std::min(block, inFrames - i_in),
+                                &o[i_out * nch], outFrames - i_out);
+                            i_in += count.consumed;
+                            i_out += count.produced;
+                        }
+                        o.resize(i_out * nch);
+                    }
+
+                    char what[128];
+                    snprintf(what, sizeof(what), "%u->%u%s, %u channels%s, blocks of %zu",
+                             rate.in, rate.out, rate.rational ? " rational" : "",
+                             nch, interpolated ? ", interpolated" : "", block);
+
+                    if (out[0].size() != out[1].size()) {
+                        fail("folded count differs from full", what);
+                        continue;
+                    }
+                    for (size_t i = 0; i < out[0].size(); ++i) {
+                        if (std::fabs(out[0][i] - out[1][i]) > 1e-5f) {
+                            fail("folded output differs from full", what);
+                            break;
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+/**
+   The halfband resamplers compute the direct convolution of their filter,
+   after the insertion of zeros when interpolating, whatever the blocks.
+ */
+static void checkHalfband()
+{
+    const size_t inFrames = 3000;
+
+    for (HalfbandResampler::Direction direction : {HalfbandResampler::Down, HalfbandResampler::Up}) {
+        for (uint32_t taps : {3u, 19u, 59u}) {
+            for (uint32_t nch : {1u, 3u}) {
+                const bool up = direction == HalfbandResampler::Up;
+                HalfbandResampler rsm(nch);
+                rsm.setup(direction, taps);
+
+                // windowed sinc of 4k-1 taps: the center is one half, and
+                // the others at odd offsets sum to one half
+                const int k = (int)(taps + 1) / 4;
+                const int center = 2 * k - 1;
+                std::vector<double> h(4 * k - 1, 0.0);
+                double sum = 0;
+                for (int t = 0; t < 4 * k - 1; ++t) {
+                    int d = t - center;
+                    if (d % 2 == 0)
+                        continue;
+                    double x = 0.5 * M_PI * d;
+                    double w = d / (2.0 * k);
+                    h[t] = std::sin(x) / x * ResamplerMath::i0(M_PI * 2.5 * std::sqrt(1 - w * w));
+                    sum += h[t];
+                }
+                for (double &v : h)
+                    v *= 0.5 / sum;
+                h[center] = 0.5;
+
+                // the input at the higher rate, with zeros inserted
+                std::vector<float> in = makeNoise(inFrames * nch);
+                const size_t highFrames = up ? (2 * inFrames) : inFrames;
+                std::vector<double> high(highFrames * nch, 0.0);
+                for (size_t i = 0; i < inFrames; ++i) {
+                    for (uint32_t c = 0; c < nch; ++c)
+                        high[(up ? (2 * i) : i) * nch + c] = in[i * nch + c];
+                }
+
+                const size_t outFrames = up ? (2 * inFrames) : ((inFrames + 1) / 2);
+                std::vector<float> out(outFrames * nch);
+                size_t i_in = 0;
+                size_t i_out = 0;
+                for (;;) {
+                    size_t inBlock = std::min<size_t>(1 + sRandom() % 50, inFrames - i_in);
+                    size_t outBlock = std::min<size_t>(1 + sRandom() % 40, outFrames - i_out);
+                    ResamplerCount count = rsm.process(&in[i_in * nch], inBlock, &out[i_out * nch], outBlock);
+                    i_in += count.consumed;
+                    i_out += count.produced;
+                    if (count.consumed == 0 && count.produced == 0)
+                        break;
+                }
+
+                char what[128];
+                snprintf(what, sizeof(what), "%s, %u taps, %u channels", up ? "up" : "down", taps, nch);
+
+                if (i_in != inFrames || i_out != outFrames) {
+                    fail("halfband counts differ", what);
+                    continue;
+                }
+
+                const size_t step = up ? 1 : 2;
+                const double gain = up ? 2 : 1;
+                for (size_t i = 0; i < outFrames * nch; ++i) {
+                    const size_t frame = i / nch * step;
+                    const uint32_t c = i % nch;
+                    double expected = 0;
+                    for (size_t t = 0; t < h.size() && t <= frame; ++t)
+                        expected += gain * h[t] * high[(frame - t) * nch + c];
+                    if (std::fabs(out[i] - expected) > 1e-5) {
+                        fail("halfband differs from the direct convolution", what);
+                        break;
+                    }
+                }
+            }
+        }
+    }
+}
+
+/**
+   The predicted counts of frames are the ones of the processing.
+ */
+template <class T>
+static void checkCounts(const char *type)
+{
+    for (const CheckRate &rate : sRates) {
+        for (uint32_t nch : {1u, 2u, 8u}) {
+            DynamicResampler<32> rsm(nch);
+            setupRate(rsm, rate);
+
+            std::vector<T> in(4096 * nch);
+            std::vector<T> out(16 * 4096 * nch);
+
+            char what[128];
+            snprintf(what, sizeof(what), "%s, %u->%u%s, %u channels", type,
+                     rate.in, rate.out, rate.rational ? " rational" : "", nch);
+
+            for (unsigned block = 0; block < 200; ++block) {
+                // the fewest input frames for some output frames, on a copy
+                DynamicResampler<32> copy(rsm);
+                size_t outFrames = sRandom() % 500;
+                size_t needed = (size_t)copy.inputsFor(outFrames);
+                if (needed > 4096)
+                    continue;
+                if (copy.outputsFor(needed) < outFrames)
+                    fail("outputsFor less than requested to inputsFor", what);
+                if (needed > 0) {
+                    DynamicResampler<32> fewer(copy);
+                    if (fewer.process(in.data(), needed - 1, out.data(), outFrames).produced >= outFrames)
+                        fail("inputsFor not the fewest", what);
+                }
+                ResamplerCount count = copy.process(in.data(), needed, out.data(), outFrames);
+                if (count.consumed != needed || count.produced != outFrames)
+                    fail("inputsFor not enough", what);
+
+                // all the output frames of an input block
+                size_t inFrames = (block % 3 == 0) ? (sRandom() % 40) : (sRandom() % 4096);
+                size_t predicted = (size_t)rsm.outputsFor(inFrames);
+                if (rsm.push(in.data(), inFrames, out.data()) != predicted)
+                    fail("push differs from outputsFor", what);
+            }
+        }
+    }
+}
+
+/**
+   A change of quality in the middle of the stream continues with the
+   output of the new quality, delayed like the quality at the start.
+ */
+static void checkPresetSwitch()
+{
+    const size_t inFrames = 4096;
+    const size_t outCapacity = 3 * inFrames;
+    const size_t switchFrames = 1000;
+
+    for (double ratio : {2.0, 0.5}) {
+        for (ResamplerPreset to : {ResamplerPreset::Low, ResamplerPreset::Best}) {
+            const uint32_t nch = 2;
+            std::vector<float> in = makeNoise(inFrames * nch);
+
+            PresetResampler reference(nch);
+            reference.setup(ratio);
+            reference.setQuality(to);
+            std::vector<float> expected(outCapacity * nch);
+            ResamplerCount all = reference.process(in.data(), inFrames, expected.data(), outCapacity);
+
+            PresetResampler rsm(nch);
+            rsm.setup(ratio);
+            std::vector<float> out(outCapacity * nch);
+            ResamplerCount first = rsm.process(in.data(), switchFrames, out.data(), outCapacity);
+            rsm.setQuality(to);
+            size_t produced = first.produced;
+            for (size_t consumed = first.consumed; consumed < inFrames;) {
+                ResamplerCount count = rsm.process(
+                    &in[consumed * nch], inFrames - consumed, &out[produced * nch], outCapacity - produced);
+                consumed += count.consumed;
+                produced += count.produced;
+                if (count.consumed == 0 && count.produced == 0)
+                    break;
+            }
+
+            // the difference of latency, in output frames
+            const ResamplerQuality high = ResamplerQuality::preset(ResamplerPreset::High);
+            const ResamplerQuality quality = ResamplerQuality::preset(to);
+            const long offset = std::lround(0.5 * ratio * ((double)quality.ksize - (double)high.ksize));
+
+            char what[128];
+            snprintf(what, sizeof(what), "ratio %g, 32 to %u taps", ratio, quality.ksize);
+
+            size_t begin = first.produced;
+            size_t end = std::min(produced, (size_t)((long)all.produced - offset));
+            if ((long)begin + offset < 0 || end <= begin)
+                fail("too few frames to compare", what);
+            else if (!sameBits(&out[begin * nch], &expected[(begin + offset) * nch], (end - begin) * nch))
+                fail("output differs after the change", what);
+        }
+    }
+}
+
+/**
+   The ring buffer keeps the frames in order across the wraparound, and it
+   transfers exactly the frames which fit or which are readable.
+ */
+static void checkRing()
+{
+    const uint32_t nch = 2;
+    ResamplerRingBuffer ring(nch, 100);
+    if (ring.capacity() != 128)
+        fail("ring capacity not rounded to a power of two", "100 frames");
+
+    // frames numbered in sequence, both channels
+    std::vector<float> frames(4 * 128 * nch);
+    size_t written = 0;
+    size_t read = 0;
+    auto fill = [&frames, nch](size_t first, size_t count) {
+        for (size_t i = 0; i < count; ++i)
+            for (uint32_t c = 0; c < nch; ++c)
+                frames[i * nch + c] = (float)(first + i) + 0.5f * c;
+    };
+
+    // full, then empty
+    fill(0, 200);
+    if (ring.write(frames.data(), 200) != 128 || ring.writable() != 0 || ring.readable() != 128)
+        fail("ring counts when full", "write 200 into 128");
+    if (ring.write(frames.data(), 1) != 0)
+        fail("ring counts when full", "write into a full ring");
+    std::vector<float> got(4 * 128 * nch);
+    if (ring.read(got.data(), 200) != 128 || ring.readable() != 0 || ring.writable() != 128)
+        fail("ring counts when empty", "read 200 from 128");
+    if (ring.read(got.data(), 1) != 0)
+        fail("ring counts when empty", "read from an empty ring");
+    fill(0, 128);
+    if (!sameBits(got.data(), frames.data(), 128 * nch))
+        fail("ring frames differ", "full ring");
+    written = read = 128;
+
+    // random sizes, which wrap around many times
+    for (unsigned step = 0; step < 2000; ++step) {
+        size_t count = sRandom() % 150;
+        size_t expected = std::min(count, ring.capacity() - (written - read));
+        fill(written, count);
+        if (ring.write(frames.data(), count) != expected)
+            fail("ring write count", "random sizes");
+        written += expected;
+
+        count = sRandom() % 150;
+        expected = std::min(count, written - read);
+        size_t n;
+        if (step % 2 == 0)
+            n = ring.read(got.data(), count);
+        else {
+            // in place, in two parts
+            ResamplerRingBuffer::Region region = ring.readRegion();
+            if (region.firstFrames + region.secondFrames != written - read)
+                fail("ring region count", "random sizes");
+            n = std::min(count, region.firstFrames + region.secondFrames);
+            size_t part = std::min(n, region.firstFrames);
+            std::memcpy(got.data(), region.first, part * nch * sizeof(float));
+            std::memcpy(&got[part * nch], region.second, (n - part) * nch * sizeof(float));
+            ring.consume(n);
+        }
+        if (n != expected)
+            fail("ring read count", "random sizes");
+        fill(read, n);
+        if (!sameBits(got.data(), frames.data(), n * nch)) {
+            fail("ring frames differ", "random sizes");
+            break;
+        }
+        read += n;
+
+        if (ring.readable() != written - read || ring.writable() != ring.capacity() - (written - read))
+            fail("ring counts", "random sizes");
+    }
+
+    // the resampler reads across the wraparound like from contiguous input
+    DynamicResampler<32> rsm(nch);
+    rsm.setup(48000.0 / 44100.0);
+    DynamicResampler<32> reference(rsm);
+    ResamplerRingBuffer wrapped(nch, 256);
+    std::vector<float> in = makeNoise(2048 * nch);
+    std::vector<float> out(256 * nch);
+    std::vector<float> expected(256 * nch);
+    size_t consumed = 0;
+    for (unsigned block = 0; block < 8; ++block) {
+        consumed += wrapped.write(&in[consumed * nch], 200 - wrapped.readable());
+        size_t before = wrapped.readable();
+        ResamplerCount count = resampleFromRing(rsm, wrapped, out.data(), 150);
+        ResamplerCount direct = reference.process(&in[(consumed - before) * nch], before, expected.data(), 150);
+        if (count.consumed != direct.consumed || count.produced != direct.produced ||
+            !sameBits(out.data(), expected.data(), count.produced * nch)) {
+            fail("resampling from the ring differs from contiguous input", "48000/44100");
+            break;
+        }
+    }
+}
+
+/**
+   The drift controller converges to the relative drift of the clocks, and
+   keeps the FIFO near its target with no underruns or overruns.
+ */
+static void checkDrift()
+{
+    const double rate = 48000;
+    const double inPpm = 100;
+    const double outPpm = -50;
+    const size_t inBlock = 256;
+    const size_t outBlock = 480;
+    const double target = 1024;
+    const double seconds = 120;
+
+    const double inClock = rate * (1 + 1e-6 * inPpm);
+    const double outClock = rate * (1 + 1e-6 * outPpm);
+
+    AsyncResampler<> rsm(1);
+    rsm.setup(1.0, rate, target);
+
+    ResamplerRingBuffer fifo(1, 4096);
+    std::vector<float> in(inBlock, 0.0f);
+    std::vector<float> out(outBlock);
+    std::vector<float> silence((size_t)target);
+    fifo.write(silence.data(), silence.size());
+
+    double lastWrite = 0;
+    uint64_t inBlocks = 0;
+    uint64_t outBlocks = 0;
+    unsigned underruns = 0;
+    unsigned overruns = 0;
+    size_t minFill = SIZE_MAX;
+    size_t maxFill = 0;
+
+    for (;;) {
+        double inTime = inBlocks * inBlock / inClock;
+        double outTime = outBlocks * outBlock / outClock;
+        double time = std::min(inTime, outTime);
+        if (time >= seconds)
+            break;
+
+        if (inTime <= outTime) {
+            if (fifo.write(in.data(), inBlock) < inBlock)
+                ++overruns;
+            lastWrite = inTime;
+            ++inBlocks;
+            continue;
+        }
+
+        size_t fill = fifo.readable();
+        if (time > 0.5 * seconds) {
+            minFill = std::min(minFill, fill);
+            maxFill = std::max(maxFill, fill);
+        }
+        rsm.track(fill + (time - lastWrite) * rate - 0.5 * inBlock, outBlock);
+        if (resampleFromRing(rsm, fifo, out.data(), outBlock).produced < outBlock)
+            ++underruns;
+        ++outBlocks;
+    }
+
+    const double expected = (1e-6 * inPpm - 1e-6 * outPpm) / (1 + 1e-6 * outPpm);
+    const double drift = rsm.controller().drift();
+
+    char what[128];
+    snprintf(what, sizeof(what), "expected %.3f ppm, estimated %.3f ppm, fill [%zu:%zu]",
+             1e6 * expected, 1e6 * drift, minFill, maxFill);
+
+    if (std::fabs(drift - expected) > 1e-6)
+        fail("drift not tracked", what);
+    if (underruns > 0 || overruns > 0)
+        fail("FIFO underrun or overrun", what);
+    if (minFill < target - inBlock - outBlock || maxFill > target + inBlock + outBlock)
+        fail("fill away from the target", what);
+}
+
+/**
+   Measure the impulse response of a resampler at ratio 1: its sum, and its
+   center of mass relative to the impulse, in frames.
+ */
+template <class R>
+static void measureImpulse(R &rsm, double &gain, double &delay)
+{
+    const size_t at = 100;
+    std::vector<float> in(400, 0.0f);
+    std::vector<float> out(400);
+    in[at] = 1;
+
+    ResamplerCount count = rsm.process(in.data(), in.size(), out.data(), out.size());
+    double moment = 0;
+    double sum = 0;
+    for (size_t i = 0; i < count.produced; ++i) {
+        moment += (double)i * out[i];
+        sum += out[i];
+    }
+    gain = sum;
+    delay = (sum != 0) ? (moment / sum - at) : 0;
+}
+
+/**
+   The minimum-phase kernel has the gain of the linear-phase one at low
+   frequencies, and less delay.
+ */
+static void checkMinimumPhase()
+{
+    DynamicResampler<32> linear(1);
+    linear.setup(1.0);
+    DynamicResampler<32> minimum(1);
+    minimum.core().setResponse(ResamplerResponse::MinimumPhase);
+    minimum.setup(1.0);
+
+    double linearGain, linearDelay, minimumGain, minimumDelay;
+    measureImpulse(linear, linearGain, linearDelay);
+    measureImpulse(minimum, minimumGain, minimumDelay);
+
+    char what[128];
+    snprintf(what, sizeof(what), "gain %.6f and %.6f, delay %.3f and %.3f",
+             linearGain, minimumGain, linearDelay, minimumDelay);
+
+    if (std::fabs(minimumGain - linearGain) > 1e-3 * std::fabs(linearGain))
+        fail("minimum phase changes the DC gain", what);
+    if (!(minimum.core().delay() < linear.core().delay()) || !(minimumDelay < linearDelay))
+        fail("minimum phase does not reduce the delay", what);
+    if (std::fabs(minimum.core().delay() - minimumDelay) > 1e-2)
+        fail("minimum-phase delay differs from the impulse response", what);
+}
+
+/**
+   The latency is the delay of the impulse response, to the nearest frame.
+ */
+static void checkLatency()
+{
+    for (ResamplerPreset preset : {ResamplerPreset::Low, ResamplerPreset::Medium, ResamplerPreset::High, ResamplerPreset::Best}) {
+        PresetResampler rsm(1);
+        rsm.setup(1.0);
+        rsm.setQuality(preset);
+
+        double gain, delay;
+        measureImpulse(rsm, gain, delay);
+
+        char what[128];
+        snprintf(what, sizeof(what), "%u taps, latency %u, measured %.3f",
+                 ResamplerQuality::preset(preset).ksize, rsm.latency(), delay);
+        if (std::fabs(rsm.latency() - delay) > 0.5 + 1e-6)
+            fail("latency differs from the impulse delay", what);
+    }
+
+    DynamicResampler<32> minimum(1);
+    minimum.core().setResponse(ResamplerResponse::MinimumPhase);
+    minimum.setup(1.0);
+    double gain, delay;
+    measureImpulse(minimum, gain, delay);
+    char what[128];
+    snprintf(what, sizeof(what), "minimum phase, latency %u, measured %.3f", minimum.latency(), delay);
+    if (std::fabs(minimum.latency() - delay) > 0.5 + 1e-6)
+        fail("latency differs from the impulse delay", what);
+}
+
+/**
+   The streams of a multi-stream resampler are the ones of a mono resampler
+   shifted by their offsets, including the negative ones.
+ */
+static void checkMultiStream()
+{
+    const size_t inFrames = 1000;
+
+    for (double ratio : {3.0, 2.0, 48000.0 / 44100.0}) {
+        // in phase, advanced by half a frame, delayed by one and by half
+        const double offsets[] = {0, 0.5, -1, -0.5};
+        const uint32_t streams = 4;
+        MultiStreamResampler<32> rsm(streams);
+        rsm.setup(ratio);
+        rsm.setPhaseOffsets(offsets);
+
+        const size_t outCapacity = (size_t)(inFrames * ratio) + 8;
+        std::vector<float> in = makeNoise(inFrames);
+        std::vector<std::vector<float>> out(streams, std::vector<float>(outCapacity));
+        const float *ins[streams];
+        float *outs[streams];
+        for (uint32_t s = 0; s < streams; ++s) {
+            ins[s] = in.data();
+            outs[s] = out[s].data();
+        }
+        ResamplerCount counts[streams];
+        rsm.process(ins, inFrames, outs, outCapacity, counts);
+
+        char what[128];
+        snprintf(what, sizeof(what), "ratio %g, produced %zu, %zu, %zu, %zu", ratio,
+                 counts[0].produced, counts[1].produced, counts[2].produced, counts[3].produced);
+
+        // the offsets 0 and 0.5 against a mono resampler
+        for (uint32_t s = 0; s < 2; ++s) {
+            DynamicResampler<32> mono(1);
+            mono.setup(ratio);
+            mono.core().shift(offsets[s]);
+            std::vector<float> expected(outCapacity);
+            ResamplerCount count = mono.process(in.data(), inFrames, expected.data(), outCapacity);
+            if (count.consumed != counts[s].consumed || count.produced != counts[s].produced ||
+                !sameBits(expected.data(), out[s].data(), count.produced))
+                fail("stream differs from a mono resampler", what);
+        }
+
+        // the negative offsets have as many more outputs
+        for (uint32_t s = 2; s < streams; ++s) {
+            double more = -offsets[s] * ratio;
+            if (std::fabs((double)counts[s].produced - (double)counts[0].produced - more) > 1)
+                fail("wrong count of a negative offset", what);
+        }
+
+        // delayed by whole outputs, the same frames after silence
+        if (ratio == 2.0) {
+            const size_t delay = 2;
+            bool silent = out[2][0] == 0 && out[2][1] == 0;
+            if (!silent || counts[2].produced != counts[0].produced + delay ||
+                !sameBits(&out[2][delay], out[0].data(), counts[0].produced))
+                fail("negative offset differs from the delayed stream", what);
+        }
+    }
+}
+
+/**
+   The counters of the instrumentation count the frames processed, and
+   stay zero in the builds without it.
+ */
+static void checkStats()
+{
+    const uint32_t nch = 2;
+    std::vector<float> in = makeNoise(4096 * nch);
+    std::vector<float> out(3 * 4096 * nch);
+
+    DynamicResampler<32> rsm(nch);
+    rsm.setup(48000.0 / 44100.0);
+    PresetResampler preset(nch);
+    preset.setup(48000.0 / 44100.0);
+
+    uint64_t consumed = 0;
+    uint64_t produced = 0;
+    uint64_t presetConsumed = 0;
+    uint64_t presetProduced = 0;
+    for (unsigned block = 0; block < 20; ++block) {
+        size_t inFrames = 1 + sRandom() % 4096;
+        size_t outFrames = 1 + sRandom() % (3 * 4096);
+        ResamplerCount count = rsm.process(in.data(), inFrames, out.data(), outFrames);
+        consumed += count.consumed;
+        produced += count.produced;
+        count = preset.process(in.data(), inFrames, out.data(), outFrames);
+        presetConsumed += count.consumed;
+        presetProduced += count.produced;
+    }
+
+    const ResamplerStats stats = rsm.stats();
+    const ResamplerStats presetStats = preset.stats();
+    const bool enabled = ResamplerStats::enabled();
+
+    char what[128];
+    snprintf(what, sizeof(what), "%s, counted %llu/%llu and %llu/%llu",
+             enabled ? "enabled" : "disabled",
+             (unsigned long long)stats.inputFrames, (unsigned long long)stats.outputFrames,
+             (unsigned long long)presetStats.inputFrames, (unsigned long long)presetStats.outputFrames);
+
+    if (stats.inputFrames != (enabled ? consumed : 0) || stats.outputFrames != (enabled ? produced : 0) ||
+        (stats.calls == 0) == enabled)
+        fail("DynamicResampler counters", what);
+    if (presetStats.inputFrames != (enabled ? presetConsumed : 0) ||
+        presetStats.outputFrames != (enabled ? presetProduced : 0))
+        fail("PresetResampler counters", what);
+
+    rsm.resetStats();
+    preset.resetStats();
+    if (rsm.stats().calls != 0 || preset.stats().calls != 0)
+        fail("counters not reset", what);
+}
+
+int main()
+{
+    checkDot4();
+    checkDotVariants();
+    checkChunked();
+    checkFolded();
+    checkCounts<float>("float");
+    checkCounts<int16_t>("int16");
+    checkPresetSwitch();
+    checkRing();
+    checkDrift();
+    checkMinimumPhase();
+    checkLatency();
+    checkMultiStream();
+    checkHalfband();
+    checkStats();
+
+    if (sFailures > 0) {
+        printf("%u checks failed\n", sFailures);
+        return 1;
+    }
+
+    printf("All checks passed\n");
+    return 0;
+}
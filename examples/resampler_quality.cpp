@@ -0,0 +1,464 @@
+#include "parallel_resampler.h"
+#include "cascade_resampler.h"
+#include "preset_resampler.h"
+#if defined(HAVE_FILE_RESAMPLERS)
+#include "file_resamplers.h"
+#endif
+#include <getopt.h>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+typedef void (resample_fn_t)(
+    double input_rate, double output_rate,
+    const float *in, size_t in_frames,
+    float *out, size_t out_frames,
+    unsigned channels);
+
+struct QualityChoice {
+    const char *name;
+    resample_fn_t *resample;
+};
+
+enum class ConfigMode {
+    Table,
+    Interpolated,
+    Rational,
+    MinimumPhase,
+    Float16,
+    BFloat16,
+    Folded16,
+};
+
+template <uint32_t Ksize, uint32_t Ktable, ConfigMode Mode>
+static void resample_with_config(
+    double input_rate, double output_rate,
+    const float *in, size_t in_frames,
+    float *out, size_t out_frames,
+    unsigned channels)
+{
+    DynamicResampler<Ksize, Ktable> rsm(channels);
+    if (Mode == ConfigMode::Rational)
+        rsm.setupRational((uint32_t)input_rate, (uint32_t)output_rate);
+    else {
+        rsm.setup(output_rate / input_rate);
+        rsm.core().setInterpolated(Mode == ConfigMode::Interpolated);
+    }
+    if (Mode == ConfigMode::MinimumPhase)
+        rsm.core().setResponse(ResamplerResponse::MinimumPhase);
+    if (Mode == ConfigMode::Float16 || Mode == ConfigMode::Folded16)
+        rsm.core().setStorage(ResamplerFormat::Float16, Mode == ConfigMode::Folded16);
+    else if (Mode == ConfigMode::BFloat16)
+        rsm.core().setStorage(ResamplerFormat::BFloat16);
+    resampleParallel(rsm, in, in_frames, out, out_frames);
+}
+
+static void resample_with_cascade(
+    double input_rate, double output_rate,
+    const float *in, size_t in_frames,
+    float *out, size_t out_frames,
+    unsigned channels)
+{
+    CascadeResampler rsm(channels);
+    rsm.setup(input_rate, output_rate);
+
+    size_t i_in = 0;
+    size_t i_out = 0;
+    while (i_out < out_frames && i_in < in_frames) {
+        ResamplerCount count = rsm.process(
+            in + i_in * channels, in_frames - i_in,
+            out + i_out * channels, out_frames - i_out);
+        i_in += count.consumed;
+        i_out += count.produced;
+    }
+
+    // past the end of input, continue with silence
+    std::vector<float> silence(256 * channels);
+    while (i_out < out_frames) {
+        ResamplerCount count = rsm.process(
+            silence.data(), 256, out + i_out * channels, out_frames - i_out);
+        i_out += count.produced;
+    }
+}
+
+template <ResamplerPreset Preset>
+static void resample_with_preset(
+    double input_rate, double output_rate,
+    const float *in, size_t in_frames,
+    float *out, size_t out_frames,
+    unsigned channels)
+{
+    PresetResampler rsm(channels);
+    rsm.setup(output_rate / input_rate);
+    rsm.setQuality(Preset);
+
+    size_t i_in = 0;
+    size_t i_out = 0;
+    while (i_out < out_frames && i_in < in_frames) {
+        ResamplerCount count = rsm.process(
+            in + i_in * channels, in_frames - i_in,
+            out + i_out * channels, out_frames - i_out);
+        i_in += count.consumed;
+        i_out += count.produced;
+    }
+
+    // past the end of input, continue with silence
+    std::vector<float> silence(256 * channels);
+    while (i_out < out_frames) {
+        ResamplerCount count = rsm.process(
+            silence.data(), 256, out + i_out * channels, out_frames - i_out);
+        i_out += count.produced;
+    }
+}
+
+static const QualityChoice sConfigs[] = {
+    {"mine-k16", &resample_with_config<16, 128 * 1024, ConfigMode::Table>},
+    {"mine-k32", &resample_with_config<32, 128 * 1024, ConfigMode::Table>},
+    {"mine-k64", &resample_with_config<64, 128 * 1024, ConfigMode::Table>},
+    {"mine-k32-rational", &resample_with_config<32, 128 * 1024, ConfigMode::Rational>},
+    {"mine-k32-interp64", &resample_with_config<32, 32 * 64, ConfigMode::Interpolated>},
+    {"mine-k64-interp256", &resample_with_config<64, 64 * 256, ConfigMode::Interpolated>},
+    {"mine-k32-minphase", &resample_with_config<32, 128 * 1024, ConfigMode::MinimumPhase>},
+    {"mine-k64-minphase", &resample_with_config<64, 128 * 1024, ConfigMode::MinimumPhase>},
+    {"mine-k32-float16", &resample_with_config<32, 128 * 1024, ConfigMode::Float16>},
+    {"mine-k32-bfloat16", &resample_with_config<32, 128 * 1024, ConfigMode::BFloat16>},
+    {"mine-k32-folded16", &resample_with_config<32, 128 * 1024, ConfigMode::Folded16>},
+    {"mine-cascade", &resample_with_cascade},
+    {"mine-preset-low", &resample_with_preset<ResamplerPreset::Low>},
+    {"mine-preset-medium", &resample_with_preset<ResamplerPreset::Medium>},
+    {"mine-preset-high", &resample_with_preset<ResamplerPreset::High>},
+    {"mine-preset-best", &resample_with_preset<ResamplerPreset::Best>},
+};
+
+///
+struct QualityOptions {
+    uint32_t inRate = 44100;
+    uint32_t outRate = 48000;
+    size_t frames = 1 << 16;
+};
+
+static QualityOptions sOptions;
+
+static const double sAmplitude = 0.5;
+
+/**
+   Resample a mono signal, with the output length matching the ratio.
+ */
+static std::vector<float> runMono(const QualityChoice &qc, const std::vector<float> &in)
+{
+    size_t outFrames = (size_t)std::ceil(in.size() * (double)sOptions.outRate / sOptions.inRate);
+    std::vector<float> out(outFrames);
+    qc.resample(sOptions.inRate, sOptions.outRate, in.data(), in.size(), out.data(), outFrames, 1);
+    return out;
+}
+
+static std::vector<float> makeTone(double freq, double rate, size_t frames)
+{
+    std::vector<float> tone(frames);
+    for (size_t i = 0; i < frames; ++i)
+        tone[i] = sAmplitude * std::sin(2 * M_PI * freq * i / rate);
+    return tone;
+}
+
+/**
+   Least-squares fit of a sinusoid of known frequency over [start:end).
+   Returns its amplitude, and the power of the residual.
+ */
+static void fitSine(
+    const std::vector<float> &x, size_t start, size_t end, double freq, double rate,
+    double &amplitude, double &residualPower)
+{
+    double ss = 0, cc = 0, sc = 0, xs = 0, xc = 0;
+    for (size_t i = start; i < end; ++i) {
+        double w = 2 * M_PI * freq * i / rate;
+        double s = std::sin(w), c = std::cos(w);
+        ss += s * s;
+        cc += c * c;
+        sc += s * c;
+        xs += x[i] * s;
+        xc += x[i] * c;
+    }
+
+    double det = ss * cc - sc * sc;
+    double a = (xs * cc - xc * sc) / det;
+    double b = (xc * ss - xs * sc) / det;
+    amplitude = std::sqrt(a * a + b * b);
+
+    double residual = 0;
+    for (size_t i = start; i < end; ++i) {
+        double w = 2 * M_PI * freq * i / rate;
+        double e = x[i] - (a * std::sin(w) + b * std::cos(w));
+        residual += e * e;
+    }
+    residualPower = residual / (end - start);
+}
+
+static double powerOf(const std::vector<float> &x, size_t start, size_t end)
+{
+    double sum = 0;
+    for (size_t i = start; i < end; ++i)
+        sum += (double)x[i] * x[i];
+    return sum / (end - start);
+}
+
+static double toDB(double power)
+{
+    return 10 * std::log10(std::max(power, 1e-30));
+}
+
+///
+struct QualityReport {
+    double latency = 0;         // output frames
+    double sweepSnr = 0;        // dB
+    double toneSnr = 0;         // dB, worst tone of the passband
+    double thdn = 0;            // dB, 1 kHz tone
+    double ripple = 0;          // dB, peak-to-peak passband gain
+    double aliasRejection = 0;  // dB, worst tone of the stopband
+    double framesPerSecond = 0; // output frames
+};
+
+/**
+   Estimate the latency from the response to an impulse, with parabolic
+   interpolation of the peak.
+ */
+static double estimateLatency(const QualityChoice &qc)
+{
+    const double ratio = (double)sOptions.outRate / sOptions.inRate;
+    const size_t impulseAt = sOptions.frames / 2;
+
+    std::vector<float> in(sOptions.frames);
+    in[impulseAt] = 1;
+    std::vector<float> out = runMono(qc, in);
+
+    size_t peak = 0;
+    for (size_t i = 1; i < out.size(); ++i)
+        peak = (std::fabs(out[i]) > std::fabs(out[peak])) ? i : peak;
+
+    double offset = 0;
+    if (peak > 0 && peak + 1 < out.size()) {
+        double a = out[peak - 1], b = out[peak], c = out[peak + 1];
+        double d = a - 2 * b + c;
+        if (d != 0)
+            offset = 0.5 * (a - c) / d;
+    }
+
+    return peak + offset - impulseAt * ratio;
+}
+
+/**
+   Frequency at which a sinusoid appears after sampling at `rate`
+ */
+static double foldFrequency(double freq, double rate)
+{
+    return std::fabs(freq - rate * std::round(freq / rate));
+}
+
+/**
+   Measure the SNR of a linear chirp across the passband, against the ideal
+   chirp delayed by the latency. The latency is refined to the delay which
+   minimizes the error, starting from the estimate `latency`.
+ */
+static double measureSweep(const QualityChoice &qc, double &latency, double passband)
+{
+    const double inRate = sOptions.inRate;
+    const double outRate = sOptions.outRate;
+    const double duration = sOptions.frames / inRate;
+    const double f0 = 20;
+    const double f1 = passband;
+
+    auto chirp = [=](double t) -> double {
+        return sAmplitude * std::sin(2 * M_PI * (f0 * t + 0.5 * (f1 - f0) / duration * t * t));
+    };
+
+    std::vector<float> in(sOptions.frames);
+    for (size_t i = 0; i < in.size(); ++i)
+        in[i] = chirp(i / inRate);
+
+    std::vector<float> out = runMono(qc, in);
+    size_t start = out.size() / 8;
+    size_t end = out.size() - out.size() / 8;
+
+    double signal = 0;
+    auto noiseAt = [&](double delay) -> double {
+        double noise = 0;
+        signal = 0;
+        for (size_t i = start; i < end; ++i) {
+            double ref = chirp((i - delay) / outRate);
+            double e = out[i] - ref;
+            signal += ref * ref;
+            noise += e * e;
+        }
+        return noise;
+    };
+
+    // golden section search of the delay
+    const double g = 0.5 * (std::sqrt(5.0) - 1);
+    double a = latency - 1, b = latency + 1;
+    double c = b - g * (b - a), d = a + g * (b - a);
+    double nc = noiseAt(c), nd = noiseAt(d);
+    for (int iter = 0; iter < 40; ++iter) {
+        if (nc < nd) {
+            b = d;
+            d = c;
+            nd = nc;
+            c = b - g * (b - a);
+            nc = noiseAt(c);
+        }
+        else {
+            a = c;
+            c = d;
+            nc = nd;
+            d = a + g * (b - a);
+            nd = noiseAt(d);
+        }
+    }
+
+    latency = 0.5 * (a + b);
+    double noise = noiseAt(latency);
+    return toDB(signal / noise);
+}
+
+static QualityReport measure(const QualityChoice &qc)
+{
+    const double inRate = sOptions.inRate;
+    const double outRate = sOptions.outRate;
+    const double inNyquist = 0.5 * inRate;
+    const double outNyquist = 0.5 * outRate;
+    const double passband = 0.9 * std::min(inNyquist, outNyquist);
+    const double inPower = 0.5 * sAmplitude * sAmplitude;
+
+    QualityReport report;
+    report.latency = estimateLatency(qc);
+    report.sweepSnr = measureSweep(qc, report.latency, passband);
+
+    // tones of the passband: SNR and gain
+    double minGain = 0, maxGain = 0;
+    const int numTones = 12;
+    for (int k = 0; k < numTones; ++k) {
+        double freq = 50 * std::pow(passband / 50, k / (numTones - 1.0));
+        std::vector<float> out = runMono(qc, makeTone(freq, inRate, sOptions.frames));
+        size_t start = out.size() / 8;
+        size_t end = out.size() - out.size() / 8;
+
+        double amplitude, residual;
+        fitSine(out, start, end, freq, outRate, amplitude, residual);
+        double snr = toDB(0.5 * amplitude * amplitude / residual);
+        double gain = 20 * std::log10(amplitude / sAmplitude);
+
+        report.toneSnr = (k == 0) ? snr : std::min(report.toneSnr, snr);
+        minGain = (k == 0) ? gain : std::min(minGain, gain);
+        maxGain = (k == 0) ? gain : std::max(maxGain, gain);
+    }
+    report.ripple = maxGain - minGain;
+
+    // 1 kHz tone: THD+N
+    {
+        std::vector<float> out = runMono(qc, makeTone(1000, inRate, sOptions.frames));
+        size_t start = out.size() / 8;
+        size_t end = out.size() - out.size() / 8;
+        double amplitude, residual;
+        fitSine(out, start, end, 1000, outRate, amplitude, residual);
+        report.thdn = toDB(residual / (0.5 * amplitude * amplitude));
+    }
+
+    // tones of the stopband: power of aliases when downsampling, or power
+    // of images when upsampling
+    double worst = 0;
+    const int numAliases = 8;
+    for (int k = 0; k < numAliases; ++k) {
+        double power;
+        if (outRate < inRate) {
+            double lo = 1.1 * outNyquist;
+            double hi = 0.95 * inNyquist;
+            double freq = lo + (hi - lo) * k / (numAliases - 1.0);
+            std::vector<float> out = runMono(qc, makeTone(freq, inRate, sOptions.frames));
+            power = powerOf(out, out.size() / 8, out.size() - out.size() / 8);
+        }
+        else {
+            double freq = inNyquist * (0.1 + 0.8 * k / (numAliases - 1.0));
+            double image = foldFrequency(inRate - freq, outRate);
+            if (std::fabs(image - freq) < 0.01 * outNyquist)
+                continue;
+            std::vector<float> out = runMono(qc, makeTone(freq, inRate, sOptions.frames));
+            double amplitude, residual;
+            fitSine(out, out.size() / 8, out.size() - out.size() / 8, image, outRate, amplitude, residual);
+            power = 0.5 * amplitude * amplitude;
+        }
+        worst = std::max(worst, power);
+    }
+    report.aliasRejection = (worst > 0) ? -toDB(worst / inPower) : 0;
+
+    // throughput on noise
+    {
+        std::vector<float> in(sOptions.frames);
+        std::minstd_rand prng;
+        std::uniform_real_distribution<float> dist(-0.5f, 0.5f);
+        for (float &x : in)
+            x = dist(prng);
+        auto t0 = std::chrono::steady_clock::now();
+        std::vector<float> out = runMono(qc, in);
+        auto t1 = std::chrono::steady_clock::now();
+        report.framesPerSecond = out.size() / std::chrono::duration<double>(t1 - t0).count();
+    }
+
+    return report;
+}
+
+static void printReport(const char *name, const QualityReport &report)
+{
+    static bool first = true;
+    printf("%s\n  {\"engine\": \"%s\", \"in_rate\": %u, \"out_rate\": %u, "
+           "\"latency\": %.3f, \"sweep_snr_db\": %.2f, \"tone_snr_db\": %.2f, "
+           "\"thdn_db\": %.2f, \"ripple_db\": %.4f, \"alias_rejection_db\": %.2f, "
+           "\"frames_per_second\": %.1f}",
+           first ? "" : ",", name, sOptions.inRate, sOptions.outRate,
+           report.latency, report.sweepSnr, report.toneSnr,
+           report.thdn, report.ripple, report.aliasRejection,
+           report.framesPerSecond);
+    first = false;
+    fflush(stdout);
+}
+
+int main(int argc, char *argv[])
+{
+    for (int c; (c = getopt(argc, argv, "i:o:n:")) != -1;) {
+        switch (c) {
+        case 'i':
+            sOptions.inRate = (uint32_t)atol(optarg);
+            break;
+        case 'o':
+            sOptions.outRate = (uint32_t)atol(optarg);
+            break;
+        case 'n':
+            sOptions.frames = (size_t)atol(optarg);
+            break;
+        default:
+            fprintf(stderr, "Usage: resampler_quality [-i input-rate] [-o output-rate] [-n frames]\n");
+            return 1;
+        }
+    }
+
+    if (sOptions.inRate == 0 || sOptions.outRate == 0 || sOptions.frames < 1024) {
+        fprintf(stderr, "Invalid options.\n");
+        return 1;
+    }
+
+    printf("[");
+
+    for (const QualityChoice &qc : sConfigs)
+        printReport(qc.name, measure(qc));
+
+#if defined(HAVE_FILE_RESAMPLERS)
+    for (const ResamplingChoice &rc : sResamplingChoices) {
+        QualityChoice qc = {rc.name, rc.resample};
+        printReport(rc.name, measure(qc));
+    }
+#endif
+
+    printf("\n]\n");
+    return 0;
+}
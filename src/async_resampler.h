@@ -0,0 +1,101 @@
+#pragma once
+#include "dynamic_resampler.h"
+#include "resampler_drift.h"
+
+/**
+   Asynchronous resampler, for clocks which drift against each other
+
+   The ratio can change every block: the change is spread over the block
+   in small steps, so that the pitch glides instead of jumping. The kernel
+   is designed once for the nominal ratio.
+
+   A drift controller can steer the ratio from the fill level of the input
+   FIFO, with `track`.
+
+   `Ksize` convolution size (higher = more quality, latency, computation)
+   `Ktable` length of the oversampled windowed sinc table
+ */
+template <uint32_t Ksize = 32, uint32_t Ktable = 128 * 1024>
+class AsyncResampler {
+public:
+    typedef DynamicResampler<Ksize, Ktable> Base;
+
+    /**
+       Number of output frames between two steps of a ratio change
+     */
+    static constexpr uint32_t rampStep = 16;
+
+    /**
+       Create a resampler for the given number of channels.
+     */
+    explicit AsyncResampler(uint32_t channels);
+
+    /**
+       Get the number of channels.
+     */
+    uint32_t channels() const { return fResampler.channels(); }
+
+    /**
+       Set the nominal ratio of rate conversion: ratio = Fs_out/Fs_in.
+       It designs the kernel, and resets the resampler and the controller.
+
+       `inputRate` nominal input rate, in frames per second
+       `targetFill` fill level of the input FIFO to maintain, in frames
+     */
+    void setup(double ratio, double inputRate, double targetFill);
+
+    /**
+       Set the ratio to reach by the end of the next block.
+     */
+    void setRatio(double ratio) { fTargetRatio = ratio; }
+
+    /**
+       Get the ratio in use.
+     */
+    double ratio() const { return fRatio; }
+
+    /**
+       Observe the fill level of the input FIFO, in frames, and set the ratio
+       for the next `outFrames` output frames according to the controller.
+     */
+    void track(double fill, size_t outFrames);
+
+    /**
+       Reset the history and the fractional position, and return to the
+       nominal ratio.
+     */
+    void clear();
+
+    /**
+       Compute resampled frames from a block of interleaved input, gliding
+       to the ratio set last.
+       (see `Resampler::process`)
+     */
+    ResamplerCount process(const float *in, size_t inFrames, float *out, size_t outFrames);
+
+    /**
+       Get the latency introduced by this resampler, in whole input frames.
+       (see `ResamplerCore::latency`)
+     */
+    uint32_t latency() const { return fResampler.latency(); }
+
+    /**
+       Access the controller of the drift.
+     */
+    ResamplerDriftController &controller() { return fController; }
+
+    /**
+       Access the underlying resampler.
+     */
+    Base &resampler() { return fResampler; }
+
+private:
+    Base fResampler;
+    ResamplerDriftController fController;
+
+    double fNominalRatio = 1;
+    double fRatio = 1;
+    double fTargetRatio = 1;
+};
+
+#include "async_resampler.tcc"
@@ -0,0 +1,66 @@
+#include "async_resampler.h"
+
+template <uint32_t Ksize, uint32_t Ktable>
+AsyncResampler<Ksize, Ktable>::AsyncResampler(uint32_t channels)
+    : fResampler(channels)
+{
+}
+
+template <uint32_t Ksize, uint32_t Ktable>
+void AsyncResampler<Ksize, Ktable>::setup(double ratio, double inputRate, double targetFill)
+{
+    fNominalRatio = ratio;
+    fResampler.setup(ratio);
+    fController.setup(ratio, inputRate, targetFill);
+    clear();
+}
+
+template <uint32_t Ksize, uint32_t Ktable>
+void AsyncResampler<Ksize, Ktable>::track(double fill, size_t outFrames)
+{
+    setRatio(fController.update(fill, outFrames));
+}
+
+template <uint32_t Ksize, uint32_t Ktable>
+void AsyncResampler<Ksize, Ktable>::clear()
+{
+    fRatio = fNominalRatio;
+    fTargetRatio = fNominalRatio;
+    fResampler.setRatio(fNominalRatio);
+    fResampler.clear();
+    fController.reset();
+}
+
+template <uint32_t Ksize, uint32_t Ktable>
+ResamplerCount AsyncResampler<Ksize, Ktable>::process(const float *in, size_t inFrames, float *out, size_t outFrames)
+{
+    const uint32_t nch = fResampler.channels();
+
+    if (fRatio == fTargetRatio)
+        return fResampler.process(in, inFrames, out, outFrames);
+
+    // spread the change of ratio over the block
+    size_t steps = (outFrames + rampStep - 1) / rampStep;
+    ResamplerCount count{0, 0};
+
+    for (size_t k = 0; count.produced < outFrames; ++k) {
+        if (k + 1 < steps)
+            fRatio += (fTargetRatio - fRatio) / (steps - k);
+        else
+            fRatio = fTargetRatio;
+        fResampler.setRatio(fRatio);
+
+        size_t n = outFrames - count.produced;
+        n = (n < rampStep) ? n : rampStep;
+        ResamplerCount c = fResampler.process(
+            in + count.consumed * nch, inFrames - count.consumed,
+            out + count.produced * nch, n);
+        count.consumed += c.consumed;
+        count.produced += c.produced;
+
+        if (c.produced < n)
+            break;
+    }
+
+    return count;
+}
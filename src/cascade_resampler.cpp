@@ -0,0 +1,421 @@
+#include "cascade_resampler.h"
+#include "dynamic_resampler.h"
+#include "halfband_resampler.h"
+#include <algorithm>
+#include <cmath>
+
+namespace ResamplerCascade {
+
+const uint32_t kernelSizes[8] = {8, 16, 24, 32, 48, 64, 96, 128};
+
+double requiredTaps(double transition, double alpha)
+{
+    // Kaiser's estimates of the attenuation and of the filter order
+    double attenuation = M_PI * alpha / 0.1102 + 8.7;
+    transition = std::max(transition, 1e-3);
+    return (attenuation - 7.95) / (14.36 * transition) + 1;
+}
+
+/**
+   Largest number of pairs of coefficients of the halfband stages
+ */
+static const uint32_t maxHalfbandPairs = 64;
+
+static uint32_t kernelSize(double taps)
+{
+    for (uint32_t size : kernelSizes) {
+        if (size >= taps)
+            return size;
+    }
+    return kernelSizes[7];
+}
+
+/**
+   Number of rows of the tables of the fractional stages, over which they
+   convert in rational mode (see `ConvolutionStage`)
+ */
+static const uint32_t fractionalRows = 256;
+
+/**
+   Get whether a fractional stage converts in rational mode.
+ */
+static bool isRational(const ResamplerStagePlan &stage)
+{
+    double in = stage.inRate;
+    double out = stage.outRate;
+    if (in != std::floor(in) || out != std::floor(out) || in < 1 || out < 1 || in > UINT32_MAX || out > UINT32_MAX)
+        return false;
+
+    uint32_t a = (uint32_t)in;
+    uint32_t b = (uint32_t)out;
+    while (b != 0) {
+        uint32_t t = a % b;
+        a = b;
+        b = t;
+    }
+    return (uint32_t)out / a <= fractionalRows;
+}
+
+double stageCost(const ResamplerStagePlan &stage)
+{
+    // measured on frames of one channel: the convolution resamplers have
+    // a large fixed cost per frame, the interpolated mode a large cost per
+    // tap, and the halfbands amortize theirs over blocks
+    switch (stage.kind) {
+    case ResamplerStagePlan::Decimate2:
+        return 6.0 + 0.03 * (stage.ksize + 3) / 2;
+    case ResamplerStagePlan::Interpolate2:
+        return 3.5 + 0.03 * (stage.ksize + 1) / 4;
+    default:
+        if (isRational(stage))
+            return 17.0 + 0.065 * stage.ksize;
+        return 22.0 + 0.25 * stage.ksize;
+    }
+}
+
+/**
+   Plan the conversion with a given number of stages by 2.
+   Returns whether every stage is within the largest convolution size.
+ */
+static bool planOctaves(ResamplerCascadePlan &p, double inRate, double outRate, uint32_t octaves, double passband, double alpha)
+{
+    bool feasible = true;
+
+    // absolute edge of the passband
+    const double edge = 0.5 * passband * std::min(inRate, outRate);
+
+    // the transition of a stage goes from the passband edge to the first
+    // alias or image, which is as far from the lower Nyquist frequency
+    auto transition = [edge](double from, double to) -> double {
+        return (std::min(from, to) - 2 * edge) / from;
+    };
+
+    auto addStage = [&](ResamplerStagePlan::Kind kind, double from, double to) {
+        // the convolution runs at the input rate, the halfband at the higher rate
+        double rate = (kind == ResamplerStagePlan::Fractional) ? from : std::max(from, to);
+        double taps = requiredTaps(transition(from, to) * from / rate, alpha);
+        double macs;
+        ResamplerStagePlan stage;
+        stage.kind = kind;
+        stage.inRate = from;
+        stage.outRate = to;
+
+        if (kind == ResamplerStagePlan::Fractional) {
+            stage.ksize = kernelSize(taps);
+            macs = stage.ksize;
+            feasible = feasible && taps <= stage.ksize;
+        }
+        else {
+            // halfband of 4k-1 taps: 2k multiplications and the center per
+            // decimated frame, 2k per pair of interpolated frames
+            uint32_t pairs = (uint32_t)std::ceil(0.25 * (taps + 1));
+            stage.ksize = 4 * pairs - 1;
+            macs = (kind == ResamplerStagePlan::Decimate2) ? (2 * pairs + 1) : pairs;
+            feasible = feasible && pairs <= maxHalfbandPairs;
+        }
+
+        p.stages.push_back(stage);
+        p.macsPerFrame += macs * to / outRate;
+        p.cost += stageCost(stage) * to / outRate;
+    };
+
+    double scale = std::ldexp(1.0, (int)octaves);
+
+    if (outRate < inRate) {
+        // decimate at the high rate, then convert the fraction
+        double rate = inRate;
+        for (uint32_t i = 0; i < octaves; ++i, rate *= 0.5)
+            addStage(ResamplerStagePlan::Decimate2, rate, 0.5 * rate);
+        if (rate != outRate)
+            addStage(ResamplerStagePlan::Fractional, rate, outRate);
+    }
+    else {
+        // convert the fraction at the low rate, then interpolate
+        double rate = outRate / scale;
+        if (rate != inRate)
+            addStage(ResamplerStagePlan::Fractional, inRate, rate);
+        for (uint32_t i = 0; i < octaves; ++i, rate *= 2)
+            addStage(ResamplerStagePlan::Interpolate2, rate, 2 * rate);
+    }
+
+    if (p.stages.empty())
+        addStage(ResamplerStagePlan::Fractional, inRate, outRate);
+
+    double singleTaps = requiredTaps(transition(inRate, outRate), alpha);
+    p.singleStageMacsPerFrame = std::max<double>(kernelSize(singleTaps), std::ceil(singleTaps));
+
+    ResamplerStagePlan single;
+    single.kind = ResamplerStagePlan::Fractional;
+    single.inRate = inRate;
+    single.outRate = outRate;
+    single.ksize = (uint32_t)p.singleStageMacsPerFrame;
+    p.singleStageCost = stageCost(single);
+    return feasible;
+}
+
+ResamplerCascadePlan plan(double inRate, double outRate, double passband, double alpha)
+{
+    // most stages by 2 possible
+    uint32_t maxOctaves = 0;
+    double high = std::max(inRate, outRate);
+    double low = std::min(inRate, outRate);
+    for (; high >= 2 * low; high *= 0.5)
+        ++maxOctaves;
+
+    // choose the cheapest in time, preferring the plans within the
+    // convolution sizes: the count of multiply-accumulates alone favors
+    // stages whose fixed cost per frame dominates
+    ResamplerCascadePlan best;
+    bool bestFeasible = false;
+
+    for (uint32_t octaves = 0; octaves <= maxOctaves; ++octaves) {
+        ResamplerCascadePlan p;
+        bool feasible = planOctaves(p, inRate, outRate, octaves, passband, alpha);
+        bool better = (octaves == 0) ||
+            (feasible && !bestFeasible) ||
+            (feasible == bestFeasible && p.cost < best.cost);
+        if (better) {
+            best = p;
+            bestFeasible = feasible;
+        }
+    }
+
+    return best;
+}
+
+} // namespace ResamplerCascade
+
+//------------------------------------------------------------------------------
+
+/**
+   Stage which runs a convolution resampler, in rational mode if possible
+ */
+template <uint32_t Ksize>
+class ConvolutionStage : public ResamplerStage {
+public:
+    ConvolutionStage(const ResamplerStagePlan &plan, uint32_t channels)
+        : fResampler(channels)
+    {
+        double in = plan.inRate;
+        double out = plan.outRate;
+        bool integral = in == std::floor(in) && out == std::floor(out) && in <= UINT32_MAX && out <= UINT32_MAX;
+
+        if (!integral || !fResampler.setupRational((uint32_t)in, (uint32_t)out)) {
+            fResampler.setup(out / in);
+            fResampler.core().setInterpolated(true);
+        }
+    }
+
+    ResamplerCount process(const float *in, size_t inFrames, float *out, size_t outFrames) override
+    {
+        return fResampler.process(in, inFrames, out, outFrames);
+    }
+
+    void clear() override
+    {
+        fResampler.clear();
+    }
+
+    double latency() const override
+    {
+        return fResampler.latency();
+    }
+
+private:
+    DynamicResampler<Ksize, Ksize * ResamplerCascade::fractionalRows> fResampler;
+};
+
+/**
+   Stage which runs a halfband resampler, by 2 up or down
+ */
+class HalfbandStage : public ResamplerStage {
+public:
+    HalfbandStage(const ResamplerStagePlan &plan, uint32_t channels)
+        : fResampler(channels)
+    {
+        HalfbandResampler::Direction direction = (plan.kind == ResamplerStagePlan::Interpolate2) ?
+            HalfbandResampler::Up : HalfbandResampler::Down;
+        fResampler.setup(direction, plan.ksize);
+    }
+
+    ResamplerCount process(const float *in, size_t inFrames, float *out, size_t outFrames) override
+    {
+        return fResampler.process(in, inFrames, out, outFrames);
+    }
+
+    void clear() override
+    {
+        fResampler.clear();
+    }
+
+    double latency() const override
+    {
+        bool up = fResampler.direction() == HalfbandResampler::Up;
+        return fResampler.latency() * (up ? 0.5 : 2.0);
+    }
+
+private:
+    HalfbandResampler fResampler;
+};
+
+std::unique_ptr<ResamplerStage> ResamplerStage::create(const ResamplerStagePlan &plan, uint32_t channels)
+{
+    if (plan.kind != ResamplerStagePlan::Fractional)
+        return std::unique_ptr<ResamplerStage>(new HalfbandStage(plan, channels));
+
+    uint32_t ksize = ResamplerCascade::kernelSizes[7];
+    for (uint32_t size : ResamplerCascade::kernelSizes) {
+        if (size >= plan.ksize) {
+            ksize = size;
+            break;
+        }
+    }
+
+    ResamplerStage *stage;
+    switch (ksize) {
+    case 8:
+        stage = new ConvolutionStage<8>(plan, channels);
+        break;
+    case 16:
+        stage = new ConvolutionStage<16>(plan, channels);
+        break;
+    case 24:
+        stage = new ConvolutionStage<24>(plan, channels);
+        break;
+    case 32:
+        stage = new ConvolutionStage<32>(plan, channels);
+        break;
+    case 48:
+        stage = new ConvolutionStage<48>(plan, channels);
+        break;
+    case 64:
+        stage = new ConvolutionStage<64>(plan, channels);
+        break;
+    case 96:
+        stage = new ConvolutionStage<96>(plan, channels);
+        break;
+    default:
+        stage = new ConvolutionStage<128>(plan, channels);
+        break;
+    }
+
+    return std::unique_ptr<ResamplerStage>(stage);
+}
+
+//------------------------------------------------------------------------------
+
+CascadeResampler::CascadeResampler(uint32_t channels)
+    : fChannels(channels)
+{
+}
+
+void CascadeResampler::setup(double inRate, double outRate, double passband)
+{
+    setup(ResamplerCascade::plan(inRate, outRate, passband));
+}
+
+void CascadeResampler::setup(const ResamplerCascadePlan &plan)
+{
+    const size_t numStages = plan.stages.size();
+
+    fPlan = plan;
+    fStages.clear();
+    for (const ResamplerStagePlan &stage : plan.stages)
+        fStages.push_back(ResamplerStage::create(stage, fChannels));
+
+    fBuffers.assign((numStages > 0) ? (numStages - 1) : 0, std::vector<float>(bufferFrames * fChannels));
+    fBufferStart.assign(fBuffers.size(), 0);
+    fBufferEnd.assign(fBuffers.size(), 0);
+
+    // the largest intermediate rate, relative to the input, bounds the
+    // chunk, with a margin of a few frames per stage for the rounding
+    double gain = 1;
+    double maxGain = 1;
+    for (size_t s = 0; s < fBuffers.size(); ++s) {
+        gain *= plan.stages[s].outRate / plan.stages[s].inRate;
+        maxGain = std::max(maxGain, gain);
+    }
+    fChunkFrames = std::max<size_t>(1, (size_t)((bufferFrames - 4 * numStages) / maxGain));
+}
+
+void CascadeResampler::clear()
+{
+    for (std::unique_ptr<ResamplerStage> &stage : fStages)
+        stage->clear();
+    std::fill(fBufferStart.begin(), fBufferStart.end(), 0);
+    std::fill(fBufferEnd.begin(), fBufferEnd.end(), 0);
+}
+
+ResamplerCount CascadeResampler::process(const float *in, size_t inFrames, float *out, size_t outFrames)
+{
+    const uint32_t nch = fChannels;
+    const size_t numStages = fStages.size();
+    ResamplerCount total{0, 0};
+
+    if (numStages == 0)
+        return total;
+
+    // every pass runs the stages in order, on a chunk of the input: each
+    // one reads what is left in its input buffer, which is rewound once
+    // empty, so the frames are never moved
+    for (bool progress = true; progress && total.produced < outFrames;) {
+        progress = false;
+
+        for (size_t s = 0; s < numStages; ++s) {
+            const bool first = s == 0;
+            const bool last = s + 1 == numStages;
+
+            const float *src;
+            size_t srcFrames;
+            if (first) {
+                src = in + total.consumed * nch;
+                srcFrames = std::min(inFrames - total.consumed, fChunkFrames);
+            }
+            else {
+                src = fBuffers[s - 1].data() + fBufferStart[s - 1] * nch;
+                srcFrames = fBufferEnd[s - 1] - fBufferStart[s - 1];
+            }
+
+            float *dst;
+            size_t dstFrames;
+            if (last) {
+                dst = out + total.produced * nch;
+                dstFrames = outFrames - total.produced;
+            }
+            else {
+                dst = fBuffers[s].data() + fBufferEnd[s] * nch;
+                dstFrames = bufferFrames - fBufferEnd[s];
+            }
+
+            ResamplerCount count = fStages[s]->process(src, srcFrames, dst, dstFrames);
+            progress = progress || count.consumed > 0 || count.produced > 0;
+
+            if (first)
+                total.consumed += count.consumed;
+            else {
+                size_t &start = fBufferStart[s - 1];
+                size_t &end = fBufferEnd[s - 1];
+                start += count.consumed;
+                if (start == end)
+                    start = end = 0;
+            }
+
+            if (last)
+                total.produced += count.produced;
+            else
+                fBufferEnd[s] += count.produced;
+        }
+    }
+
+    return total;
+}
+
+double CascadeResampler::latency() const
+{
+    const double outRate = fPlan.stages.empty() ? 1 : fPlan.stages.back().outRate;
+
+    double latency = 0;
+    for (size_t s = 0; s < fStages.size(); ++s)
+        latency += fStages[s]->latency() * outRate / fPlan.stages[s].inRate;
+    return latency;
+}
@@ -0,0 +1,204 @@
+#pragma once
+#include "resampler.h"
+#include <memory>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+/**
+   Stage of a cascade of resamplers
+ */
+struct ResamplerStagePlan {
+    /**
+       Kind of rate conversion
+     */
+    enum Kind {
+        Decimate2,
+        Interpolate2,
+        Fractional,
+    };
+
+    Kind kind;
+
+    /**
+       Input and output rates of the stage
+     */
+    double inRate;
+    double outRate;
+
+    /**
+       Convolution size of the fractional stage, or length of the halfband
+       filter of a stage by 2
+     */
+    uint32_t ksize;
+};
+
+/**
+   Decomposition of a rate conversion in stages
+ */
+struct ResamplerCascadePlan {
+    std::vector<ResamplerStagePlan> stages;
+
+    /**
+       Estimated cost, in multiply-accumulates per output frame and channel
+     */
+    double macsPerFrame = 0;
+
+    /**
+       Estimated cost of a single stage of the same quality, for comparison
+     */
+    double singleStageMacsPerFrame = 0;
+
+    /**
+       Estimated time per output frame and channel, which the planner
+       minimizes, and the one of a single stage of the same quality
+       (see `ResamplerCascade::stageCost`)
+     */
+    double cost = 0;
+    double singleStageCost = 0;
+};
+
+/**
+   Planning of cascades
+ */
+namespace ResamplerCascade {
+    /**
+       Convolution sizes which the stages can use, in increasing order
+     */
+    extern const uint32_t kernelSizes[8];
+
+    /**
+       Get the number of taps of a Kaiser windowed sinc, for a transition
+       band of width `transition` relative to the sample rate.
+     */
+    double requiredTaps(double transition, double alpha);
+
+    /**
+       Get the estimated time of a stage per output frame and channel, in
+       nanoseconds: a fixed cost per frame, for the loop and the calls, and
+       a cost per multiply-accumulate. They are calibrated on x86 with
+       AVX-512, for one channel; only their ratios matter to the planner.
+     */
+    double stageCost(const ResamplerStagePlan &stage);
+
+    /**
+       Plan the conversion from `inRate` to `outRate`.
+
+       Large ratios are divided into stages by 2, at the high rate side, and
+       one fractional stage, at the low rate side. Every stage is sized just
+       enough to protect the passband from its aliases or images; the stages
+       closer to the high rate have relaxed transitions, and need few taps.
+       The plan is the one of least estimated time, a single stage if it is
+       the cheapest, among the ones within the convolution sizes.
+
+       `passband` passband edge, relative to the lower Nyquist frequency
+       `alpha` parameter of the Kaiser window, which sets the attenuation
+     */
+    ResamplerCascadePlan plan(double inRate, double outRate, double passband = 0.9, double alpha = 2.5);
+};
+
+/**
+   Stage of a cascade, with a channel count set at runtime
+ */
+class ResamplerStage {
+public:
+    virtual ~ResamplerStage() {}
+
+    /**
+       Compute resampled frames from a block of interleaved input.
+       (see `Resampler::process`)
+     */
+    virtual ResamplerCount process(const float *in, size_t inFrames, float *out, size_t outFrames) = 0;
+
+    /**
+       Reset the history and the fractional position.
+     */
+    virtual void clear() = 0;
+
+    /**
+       Get the latency introduced by this stage, in input frames.
+     */
+    virtual double latency() const = 0;
+
+    /**
+       Create the stage of a plan.
+     */
+    static std::unique_ptr<ResamplerStage> create(const ResamplerStagePlan &plan, uint32_t channels);
+};
+
+/**
+   Resampler which runs a cascade of stages, for large ratios
+
+   Intermediate signals are kept in internal buffers, so the block API is
+   the same as `DynamicResampler`: the input consumed is the input of the
+   first stage, and the output produced is the output of the last stage.
+   The input is processed by chunks of a few thousand frames, every stage
+   running on the whole output of the previous one.
+ */
+class CascadeResampler {
+public:
+    /**
+       Create a resampler for the given number of channels.
+     */
+    explicit CascadeResampler(uint32_t channels);
+
+    /**
+       Get the number of channels.
+     */
+    uint32_t channels() const { return fChannels; }
+
+    /**
+       Plan the conversion, and create its stages.
+       (see `ResamplerCascade::plan`)
+     */
+    void setup(double inRate, double outRate, double passband = 0.9);
+
+    /**
+       Create the stages of a plan.
+     */
+    void setup(const ResamplerCascadePlan &plan);
+
+    /**
+       Get the plan in use.
+     */
+    const ResamplerCascadePlan &plan() const { return fPlan; }
+
+    /**
+       Reset the history and the intermediate buffers of all the stages.
+     */
+    void clear();
+
+    /**
+       Compute resampled frames from a block of interleaved input.
+       (see `Resampler::process`)
+     */
+    ResamplerCount process(const float *in, size_t inFrames, float *out, size_t outFrames);
+
+    /**
+       Get the latency introduced by the cascade, in output frames.
+     */
+    double latency() const;
+
+private:
+    /**
+       Capacity of the intermediate buffers, in frames
+     */
+    static constexpr size_t bufferFrames = 4096;
+
+    uint32_t fChannels = 0;
+    ResamplerCascadePlan fPlan;
+    std::vector<std::unique_ptr<ResamplerStage>> fStages;
+
+    /**
+       Output of every stage but the last, and the range of its frames which
+       the next stage has still to read
+     */
+    std::vector<std::vector<float>> fBuffers;
+    std::vector<size_t> fBufferStart;
+    std::vector<size_t> fBufferEnd;
+
+    /**
+       Most input frames of a pass, whose outputs fit in the buffers
+     */
+    size_t fChunkFrames = 0;
+};
@@ -0,0 +1,142 @@
+#pragma once
+#include "resampler.h"
+#include <algorithm>
+#include <vector>
+
+/**
+   Convolution-based realtime resampler, with a channel count set at runtime
+
+   It runs the same loop as `Resampler`, specialized for the most common
+   channel counts, and generic otherwise.
+
+   `Ksize` convolution size (higher = more quality, latency, computation)
+   `Ktable` length of the oversampled windowed sinc table
+ */
+template <uint32_t Ksize = 32, uint32_t Ktable = 128 * 1024>
+class DynamicResampler {
+public:
+    typedef ResamplerCore<Ksize, Ktable> Core;
+
+    /**
+       Create a resampler for the given number of channels.
+     */
+    explicit DynamicResampler(uint32_t channels);
+
+    /**
+       Get the number of channels.
+     */
+    uint32_t channels() const { return fChannels; }
+
+    /**
+       Set the ratio of rate conversion: ratio = Fs_out/Fs_in.
+     */
+    void setup(double ratio) { fCore.setup(ratio); }
+
+    /**
+       Change the ratio of rate conversion in the middle of a stream.
+       (see `ResamplerCore::setRatio`)
+     */
+    void setRatio(double ratio) { fCore.setRatio(ratio); }
+
+    /**
+       Set an exact ratio of rate conversion, from a pair of sample rates.
+       (see `ResamplerCore::setupRational`)
+     */
+    bool setupRational(uint32_t inRate, uint32_t outRate) { return fCore.setupRational(inRate, outRate); }
+
+    /**
+       Reset the history and the fractional position, keeping the ratio.
+     */
+    void clear();
+
+    /**
+       Reset the resampler, and position it on the output frame `outFrame`.
+       (see `ResamplerCore::seek`)
+     */
+    uint64_t seek(uint64_t outFrame);
+
+    /**
+       Compute resampled frames from a block of interleaved input.
+       (see `Resampler::process`)
+     */
+    ResamplerCount process(const float *in, size_t inFrames, float *out, size_t outFrames);
+
+    /**
+       Compute resampled frames from a block of planar input.
+       (see `Resampler::processPlanar`)
+     */
+    ResamplerCount processPlanar(const float *const in[], size_t inFrames, float *const out[], size_t outFrames);
+
+    /**
+       Compute resampled frames from a block of interleaved 16-bit input,
+       in fixed point.
+       (see `Resampler::process`)
+     */
+    ResamplerCount process(const int16_t *in, size_t inFrames, int16_t *out, size_t outFrames);
+
+    /**
+       Compute resampled frames from a block of planar 16-bit input, in
+       fixed point.
+       (see `Resampler::processPlanar`)
+     */
+    ResamplerCount processPlanar(const int16_t *const in[], size_t inFrames, int16_t *const out[], size_t outFrames);
+
+    /**
+       Compute resampled frames from a block of input, reading all of it.
+       (see `Resampler::push`)
+     */
+    size_t push(const float *in, size_t inFrames, float *out) { return process(in, inFrames, out, SIZE_MAX).produced; }
+    size_t pushPlanar(const float *const in[], size_t inFrames, float *const out[]) { return processPlanar(in, inFrames, out, SIZE_MAX).produced; }
+    size_t push(const int16_t *in, size_t inFrames, int16_t *out) { return process(in, inFrames, out, SIZE_MAX).produced; }
+    size_t pushPlanar(const int16_t *const in[], size_t inFrames, int16_t *const out[]) { return processPlanar(in, inFrames, out, SIZE_MAX).produced; }
+
+    /**
+       Get the number of output frames of the next input frames, or the
+       reverse. (see `ResamplerCore::outputsFor` and `ResamplerCore::inputsFor`)
+     */
+    uint64_t outputsFor(uint64_t inFrames) const { return fCore.outputsFor(inFrames); }
+    uint64_t inputsFor(uint64_t outFrames) const { return fCore.inputsFor(outFrames); }
+
+    /**
+       Get the latency introduced by this resampler, in whole input frames.
+       (see `ResamplerCore::latency`)
+     */
+    uint32_t latency() const { return fCore.latency(); }
+
+    /**
+       Get the performance counters, collected since the creation or the
+       last reset. (see `ResamplerCore::stats`)
+     */
+    ResamplerStats stats() const { return fCore.stats(); }
+    void resetStats() { fCore.resetStats(); }
+
+    /**
+       Access the core, for the advanced settings.
+     */
+    Core &core() { return fCore; }
+
+private:
+    template <uint32_t Nch>
+    using Channels = std::integral_constant<uint32_t, Nch>;
+
+    /**
+       Run the loop specialized for the channel count.
+     */
+    template <class T>
+    ResamplerCount processInterleaved(T *history, const T *in, size_t inFrames, T *out, size_t outFrames);
+
+    uint32_t fChannels = 0;
+    Core fCore;
+
+    /**
+       Storage for a history of Ksize samples, for each channel
+     */
+    std::vector<float> fHistory;
+
+    /**
+       Storage for the history of the 16-bit path
+     */
+    std::vector<int16_t> fHistoryInt16;
+};
+
+#include "dynamic_resampler.tcc"
@@ -0,0 +1,68 @@
+#include "dynamic_resampler.h"
+
+template <uint32_t Ksize, uint32_t Ktable>
+DynamicResampler<Ksize, Ktable>::DynamicResampler(uint32_t channels)
+    : fChannels(channels), fHistory(channels * Core::historySize), fHistoryInt16(channels * Core::historySize)
+{
+}
+
+template <uint32_t Ksize, uint32_t Ktable>
+void DynamicResampler<Ksize, Ktable>::clear()
+{
+    fCore.clear();
+    std::fill(fHistory.begin(), fHistory.end(), 0.0f);
+    std::fill(fHistoryInt16.begin(), fHistoryInt16.end(), 0);
+}
+
+template <uint32_t Ksize, uint32_t Ktable>
+uint64_t DynamicResampler<Ksize, Ktable>::seek(uint64_t outFrame)
+{
+    std::fill(fHistory.begin(), fHistory.end(), 0.0f);
+    std::fill(fHistoryInt16.begin(), fHistoryInt16.end(), 0);
+    return fCore.seek(outFrame);
+}
+
+template <uint32_t Ksize, uint32_t Ktable>
+ResamplerCount DynamicResampler<Ksize, Ktable>::process(const float *in, size_t inFrames, float *out, size_t outFrames)
+{
+    return processInterleaved(fHistory.data(), in, inFrames, out, outFrames);
+}
+
+template <uint32_t Ksize, uint32_t Ktable>
+ResamplerCount DynamicResampler<Ksize, Ktable>::process(const int16_t *in, size_t inFrames, int16_t *out, size_t outFrames)
+{
+    return processInterleaved(fHistoryInt16.data(), in, inFrames, out, outFrames);
+}
+
+template <uint32_t Ksize, uint32_t Ktable>
+template <class T>
+ResamplerCount DynamicResampler<Ksize, Ktable>::processInterleaved(T *history, const T *in, size_t inFrames, T *out, size_t outFrames)
+{
+    switch (fChannels) {
+    case 1:
+        return fCore.process(history, Channels<1>(), in, inFrames, out, outFrames);
+    case 2:
+        return fCore.process(history, Channels<2>(), in, inFrames, out, outFrames);
+    case 4:
+        return fCore.process(history, Channels<4>(), in, inFrames, out, outFrames);
+    case 6:
+        return fCore.process(history, Channels<6>(), in, inFrames, out, outFrames);
+    case 8:
+        return fCore.process(history, Channels<8>(), in, inFrames, out, outFrames);
+    default:
+        return fCore.process(history, fChannels, in, inFrames, out, outFrames);
+    }
+}
+
+template <uint32_t Ksize, uint32_t Ktable>
+ResamplerCount DynamicResampler<Ksize, Ktable>::processPlanar(const float *const in[], size_t inFrames, float *const out[], size_t outFrames)
+{
+    // planar access does not depend on the channel stride
+    return fCore.processPlanar(fHistory.data(), fChannels, in, inFrames, out, outFrames);
+}
+
+template <uint32_t Ksize, uint32_t Ktable>
+ResamplerCount DynamicResampler<Ksize, Ktable>::processPlanar(const int16_t *const in[], size_t inFrames, int16_t *const out[], size_t outFrames)
+{
+    return fCore.processPlanar(fHistoryInt16.data(), fChannels, in, inFrames, out, outFrames);
+}
@@ -0,0 +1,197 @@
+#include "halfband_resampler.h"
+#include "resampler_math.h"
+#include "resampler_simd.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+HalfbandResampler::HalfbandResampler(uint32_t channels)
+    : fChannels(channels)
+{
+    setup(Down, 31);
+}
+
+void HalfbandResampler::setup(Direction direction, uint32_t taps, double alpha)
+{
+    using ResamplerMath::i0;
+
+    const uint32_t k = std::max<uint32_t>(1, (taps + 4) / 4);
+
+    fDirection = direction;
+    fPairs = k;
+
+    // windowed sinc of cutoff one half, at the odd offsets from the center
+    const double beta = M_PI * alpha;
+    std::vector<double> half(k);
+    double sum = 0;
+    for (uint32_t j = 0; j < k; ++j) {
+        double d = 2.0 * j - (2.0 * k - 1);
+        double x = 0.5 * M_PI * d;
+        double t = d / (2.0 * k);
+        double window = i0(beta * std::sqrt(1 - t * t)) / i0(beta);
+        half[j] = 0.5 * std::sin(x) / x * window;
+        sum += half[j];
+    }
+
+    // unity gain: the pairs sum to one half, the other half is the center
+    // interpolation: gain 2, to compensate the inserted zeros
+    double gain = ((direction == Up) ? 2 : 1) * 0.25 / sum;
+    fTaps.resize(2 * k);
+    for (uint32_t j = 0; j < k; ++j) {
+        fTaps[j] = (float)(half[j] * gain);
+        fTaps[2 * k - 1 - j] = fTaps[j];
+    }
+
+    fLines.resize(fChannels * lineSize());
+    fCenters.resize((direction == Down) ? (fChannels * centerSize()) : 0);
+    clear();
+}
+
+void HalfbandResampler::clear()
+{
+    std::fill(fLines.begin(), fLines.end(), 0.0f);
+    std::fill(fCenters.begin(), fCenters.end(), 0.0f);
+    fPhase = 0;
+}
+
+ResamplerCount HalfbandResampler::process(const float *in, size_t inFrames, float *out, size_t outFrames)
+{
+    if (fDirection == Down)
+        return decimate(in, inFrames, out, outFrames);
+    else
+        return interpolate(in, inFrames, out, outFrames);
+}
+
+double HalfbandResampler::latency() const
+{
+    // the delay of the filter is 2k-1 frames at the higher rate
+    double delay = 2.0 * fPairs - 1;
+    return (fDirection == Down) ? (0.5 * delay) : delay;
+}
+
+void HalfbandResampler::filter(const float *line, uint32_t count, float *r) const
+{
+    const ResamplerSIMD::Functions &simd = ResamplerSIMD::functions();
+    const uint32_t n = 2 * fPairs;
+    const float *taps = fTaps.data();
+
+    uint32_t j = 0;
+    for (; j + 4 <= count; j += 4) {
+        const float *windows[4] = {line + j, line + j + 1, line + j + 2, line + j + 3};
+        simd.dot4(&r[j], windows, taps, n);
+    }
+    for (; j < count; ++j)
+        r[j] = simd.dot(line + j, taps, n);
+}
+
+ResamplerCount HalfbandResampler::decimate(const float *in, size_t inFrames, float *out, size_t outFrames)
+{
+    const uint32_t nch = fChannels;
+    const uint32_t k = fPairs;
+    const uint32_t history = 2 * k - 1;
+    const size_t lineFrames = lineSize();
+    const size_t centerFrames = centerSize();
+    float r[blockFrames];
+
+    size_t consumed = 0;
+    size_t produced = 0;
+
+    for (;;) {
+        // the even frames go into the filter, with an output each, and the
+        // odd ones into the delay line of the center; an odd frame is read
+        // even without room for the output after it
+        const size_t available = inFrames - consumed;
+        const uint32_t lead = fPhase;
+        size_t count = (available > lead) ? ((available - lead + 1) / 2) : 0;
+        count = std::min(count, outFrames - produced);
+        count = std::min(count, (size_t)blockFrames);
+
+        const size_t frames = std::min(available, lead + 2 * count);
+        if (frames == 0)
+            break;
+
+        // odd frames at the positions of the parity of `lead`, after the
+        // ones which the pass starts with
+        const size_t odd = (frames + 1 - (1 - lead)) / 2;
+
+        for (uint32_t c = 0; c < nch; ++c) {
+            float *line = &fLines[c * lineFrames];
+            float *centers = &fCenters[c * centerFrames];
+            const float *x = &in[consumed * nch + c];
+
+            for (size_t j = 0; j < count; ++j)
+                line[history + j] = x[(lead + 2 * j) * nch];
+            for (size_t j = 0; j < odd; ++j)
+                centers[k + j] = x[(1 - lead + 2 * j) * nch];
+
+            // the center of the output `j` is `lead` frames later than the
+            // oldest one in the line
+            filter(line, (uint32_t)count, r);
+            for (size_t j = 0; j < count; ++j)
+                out[(produced + j) * nch + c] = 0.5f * centers[j + lead] + r[j];
+
+            std::memmove(line, line + count, history * sizeof(float));
+            std::memmove(centers, centers + odd, k * sizeof(float));
+        }
+
+        consumed += frames;
+        produced += count;
+        fPhase = (uint32_t)((lead + frames) & 1);
+    }
+
+    return ResamplerCount{consumed, produced};
+}
+
+ResamplerCount HalfbandResampler::interpolate(const float *in, size_t inFrames, float *out, size_t outFrames)
+{
+    const uint32_t nch = fChannels;
+    const uint32_t k = fPairs;
+    const uint32_t history = 2 * k - 1;
+    const size_t lineFrames = lineSize();
+    float r[blockFrames];
+
+    size_t consumed = 0;
+    size_t produced = 0;
+
+    for (;;) {
+        if (fPhase == 1) {
+            // second frame of the pair: the input at the center, delayed
+            if (produced == outFrames)
+                break;
+            for (uint32_t c = 0; c < nch; ++c)
+                out[produced * nch + c] = fLines[c * lineFrames + k - 1];
+            ++produced;
+            fPhase = 0;
+        }
+
+        size_t count = std::min(inFrames - consumed, (outFrames - produced + 1) / 2);
+        count = std::min(count, (size_t)blockFrames);
+        if (count == 0)
+            break;
+
+        // the pairs of the pass, the last one without its second frame if
+        // there is no room for it
+        const size_t frames = std::min(2 * count, outFrames - produced);
+
+        for (uint32_t c = 0; c < nch; ++c) {
+            float *line = &fLines[c * lineFrames];
+            const float *x = &in[consumed * nch + c];
+            float *y = &out[produced * nch + c];
+
+            for (size_t j = 0; j < count; ++j)
+                line[history + j] = x[j * nch];
+
+            filter(line, (uint32_t)count, r);
+            for (size_t j = 0; j < frames; ++j)
+                y[j * nch] = (j & 1) ? line[j / 2 + k] : r[j / 2];
+
+            std::memmove(line, line + count, history * sizeof(float));
+        }
+
+        consumed += count;
+        produced += frames;
+        fPhase = (frames & 1) ? 1 : 0;
+    }
+
+    return ResamplerCount{consumed, produced};
+}
@@ -0,0 +1,129 @@
+#pragma once
+#include "resampler.h"
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+/**
+   Halfband resampler by a factor 2, up or down, with a channel count set
+   at runtime
+
+   The halfband lowpass has its cutoff at the quarter of the higher rate, so
+   every other coefficient is zero, except the center which is one half.
+   The polyphase form skips the zero coefficients: a filter of 4k-1 taps
+   costs 2k multiplications per decimated frame, or per pair of
+   interpolated frames. The input is filtered by blocks, and the outputs
+   by batches of 4 sharing the loads of the coefficients, as in
+   `ResamplerCore`.
+
+   It is the fast path of the stages by 2 of `CascadeResampler`, which also
+   chains them for the factor 4. `Resampler` and `DynamicResampler` do not
+   use it: a conversion by 2 goes through the cascade to get it.
+ */
+class HalfbandResampler {
+public:
+    enum Direction {
+        Up,
+        Down,
+    };
+
+    /**
+       Create a resampler for the given number of channels.
+     */
+    explicit HalfbandResampler(uint32_t channels);
+
+    /**
+       Get the number of channels.
+     */
+    uint32_t channels() const { return fChannels; }
+
+    /**
+       Design the filter, and reset the resampler.
+
+       `direction` interpolation or decimation
+       `taps` length of the filter, rounded up to the next 4k-1
+       `alpha` parameter of the Kaiser window
+     */
+    void setup(Direction direction, uint32_t taps, double alpha = 2.5);
+
+    /**
+       Get the direction of the conversion.
+     */
+    Direction direction() const { return fDirection; }
+
+    /**
+       Get the length of the filter.
+     */
+    uint32_t taps() const { return 4 * fPairs - 1; }
+
+    /**
+       Reset the history and the phase.
+     */
+    void clear();
+
+    /**
+       Compute resampled frames from a block of interleaved input.
+       (see `Resampler::process`)
+     */
+    ResamplerCount process(const float *in, size_t inFrames, float *out, size_t outFrames);
+
+    /**
+       Get the latency introduced by this resampler, in output frames.
+     */
+    double latency() const;
+
+private:
+    /**
+       Number of frames filtered per pass, which sizes the lines
+     */
+    static constexpr uint32_t blockFrames = 256;
+
+    ResamplerCount decimate(const float *in, size_t inFrames, float *out, size_t outFrames);
+    ResamplerCount interpolate(const float *in, size_t inFrames, float *out, size_t outFrames);
+
+    /**
+       Filter `count` frames of a channel: `r[j]` is the convolution of the
+       window which starts at `line + j`.
+     */
+    void filter(const float *line, uint32_t count, float *r) const;
+
+    /**
+       Get the number of frames of the lines of a channel.
+     */
+    size_t lineSize() const { return 2 * fPairs - 1 + blockFrames; }
+    size_t centerSize() const { return fPairs + blockFrames + 1; }
+
+    uint32_t fChannels = 0;
+    Direction fDirection = Down;
+
+    /**
+       Number of symmetric pairs of nonzero coefficients on either side of
+       the center, which is k for a filter of 4k-1 taps
+     */
+    uint32_t fPairs = 0;
+
+    /**
+       Nonzero coefficients, except the center, in the order of the window
+     */
+    std::vector<float> fTaps;
+
+    /**
+       Input frames which meet the nonzero coefficients, as `nch`
+       consecutive lines: the last 2k-1 frames of the previous pass, followed
+       by the frames of the pass
+     */
+    std::vector<float> fLines;
+
+    /**
+       Decimation: input frames which meet the center, as `nch` consecutive
+       lines: the last k frames of the previous pass, followed by the frames
+       of the pass
+     */
+    std::vector<float> fCenters;
+
+    /**
+       Decimation: parity of the next input frame
+       Interpolation: whether the second frame of a pair is pending
+     */
+    uint32_t fPhase = 0;
+};
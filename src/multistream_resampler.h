@@ -0,0 +1,152 @@
+#pragma once
+#include "resampler.h"
+#include <vector>
+
+/**
+   Convolution-based realtime resampler of many independent mono streams at
+   the same ratio, such as the calls of a voice server
+
+   The streams are processed together by blocks, which keep the histories of
+   their streams side by side, frame-major (see `ResamplerCore`): the kernel
+   row of an output phase is fetched once per block, and convolved with all
+   its streams at once, one stream per SIMD lane. The input of a block is
+   transposed into interleaved frames, by chunks, and convolved in place.
+
+   The streams may have phase offsets. The streams of equal offsets share
+   the same blocks, and the same positions.
+
+   `Ksize` convolution size (higher = more quality, latency, computation)
+   `Ktable` length of the oversampled windowed sinc table
+ */
+template <uint32_t Ksize = 32, uint32_t Ktable = 128 * 1024>
+class MultiStreamResampler {
+public:
+    typedef ResamplerCore<Ksize, Ktable> Core;
+
+    /**
+       Largest number of streams in a block
+       The history of a block stays in the first level of cache.
+     */
+    static constexpr uint32_t blockStreams = 64;
+
+    /**
+       Number of input frames of a block transposed at once
+     */
+    static constexpr size_t chunkFrames = 256;
+
+    /**
+       Create a resampler for the given number of streams, all in phase.
+     */
+    explicit MultiStreamResampler(uint32_t streams);
+
+    /**
+       Get the number of streams.
+     */
+    uint32_t streams() const { return fStreams; }
+
+    /**
+       Set the ratio of rate conversion: ratio = Fs_out/Fs_in.
+     */
+    void setup(double ratio);
+
+    /**
+       Set an exact ratio of rate conversion, from a pair of sample rates.
+       (see `ResamplerCore::setupRational`)
+     */
+    bool setupRational(uint32_t inRate, uint32_t outRate);
+
+    /**
+       Set the phase offsets of the streams, and reset the resampler.
+       The stream `s` is advanced by `offsets[s]` input frames: each of its
+       output frames is taken that much later in the input than the one of a
+       stream in phase, and a negative offset delays it instead.
+       (see `ResamplerCore::shift`)
+     */
+    void setPhaseOffsets(const double *offsets);
+
+    /**
+       Reset the histories and the fractional positions, keeping the ratio
+       and the phase offsets.
+     */
+    void clear();
+
+    /**
+       Compute resampled frames of all the streams, from a block of input of
+       each stream. Every stream behaves like a mono `Resampler::process`:
+       the streams in phase have the same counts, the others can differ by
+       a frame.
+
+       `in` input frames, one buffer per stream
+       `inFrames` number of input frames available in every buffer
+       `out` output frames, one buffer per stream
+       `outFrames` number of output frames requested for every stream
+       `counts` receives the number of frames processed, for every stream
+     */
+    void process(const float *const in[], size_t inFrames, float *const out[], size_t outFrames, ResamplerCount counts[]);
+
+    /**
+       Compute resampled frames of all the streams, from 16-bit input, in
+       fixed point.
+       (see `process`)
+     */
+    void process(const int16_t *const in[], size_t inFrames, int16_t *const out[], size_t outFrames, ResamplerCount counts[]);
+
+    /**
+       Get the latency introduced by this resampler, in whole input frames.
+       (see `ResamplerCore::latency`)
+     */
+    uint32_t latency() const { return fCore.latency(); }
+
+private:
+    /**
+       Streams of equal offsets processed together
+     */
+    struct Block {
+        Core core;
+        double offset = 0;
+
+        /**
+           Number of output frames of silence before the ones of the core,
+           the outputs before the start of the input of a negative offset
+         */
+        size_t silence = 0;
+        std::vector<uint32_t> streams;
+        std::vector<float> history;
+        std::vector<int16_t> historyInt16;
+    };
+
+    /**
+       Distribute the streams into blocks, according to their offsets.
+     */
+    void makeBlocks();
+
+    /**
+       Run the blocks, over the history of the sample type.
+     */
+    template <class T>
+    void processBlocks(const T *const in[], size_t inFrames, T *const out[], size_t outFrames, ResamplerCount counts[]);
+
+    static float *history(Block &block, const float *) { return block.history.data(); }
+    static int16_t *history(Block &block, const int16_t *) { return block.historyInt16.data(); }
+
+    float *scratch(const float *) { return fScratch.data(); }
+    int16_t *scratch(const int16_t *) { return fScratchInt16.data(); }
+
+    uint32_t fStreams = 0;
+
+    /**
+       Settings applied to the cores of the new blocks
+     */
+    Core fCore;
+
+    std::vector<double> fOffsets;
+    std::vector<Block> fBlocks;
+
+    /**
+       Chunk of input of a block, in interleaved frames
+     */
+    std::vector<float> fScratch;
+    std::vector<int16_t> fScratchInt16;
+};
+
+#include "multistream_resampler.tcc"
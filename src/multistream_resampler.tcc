@@ -0,0 +1,162 @@
+#include "multistream_resampler.h"
+#include <algorithm>
+#include <cmath>
+
+template <uint32_t Ksize, uint32_t Ktable>
+MultiStreamResampler<Ksize, Ktable>::MultiStreamResampler(uint32_t streams)
+    : fStreams(streams), fOffsets(streams, 0.0),
+      fScratch(chunkFrames * blockStreams), fScratchInt16(chunkFrames * blockStreams)
+{
+    makeBlocks();
+}
+
+template <uint32_t Ksize, uint32_t Ktable>
+void MultiStreamResampler<Ksize, Ktable>::setup(double ratio)
+{
+    fCore.setup(ratio);
+    for (Block &block : fBlocks)
+        block.core.setup(ratio);
+}
+
+template <uint32_t Ksize, uint32_t Ktable>
+bool MultiStreamResampler<Ksize, Ktable>::setupRational(uint32_t inRate, uint32_t outRate)
+{
+    bool rational = fCore.setupRational(inRate, outRate);
+    for (Block &block : fBlocks)
+        block.core.setupRational(inRate, outRate);
+    return rational;
+}
+
+template <uint32_t Ksize, uint32_t Ktable>
+void MultiStreamResampler<Ksize, Ktable>::setPhaseOffsets(const double *offsets)
+{
+    fOffsets.assign(offsets, offsets + fStreams);
+    makeBlocks();
+}
+
+template <uint32_t Ksize, uint32_t Ktable>
+void MultiStreamResampler<Ksize, Ktable>::clear()
+{
+    for (Block &block : fBlocks) {
+        block.core.clear();
+
+        // a position before the history window is for outputs over its
+        // zeros: output them as silence, and start from the first position
+        // in the window
+        const double incr = block.core.phase();
+        block.silence = 0;
+        if (incr + block.offset < 0)
+            block.silence = (size_t)std::ceil(-(incr + block.offset) / incr);
+        block.core.shift(block.offset + block.silence * incr);
+        std::fill(block.history.begin(), block.history.end(), 0.0f);
+        std::fill(block.historyInt16.begin(), block.historyInt16.end(), 0);
+    }
+}
+
+template <uint32_t Ksize, uint32_t Ktable>
+void MultiStreamResampler<Ksize, Ktable>::makeBlocks()
+{
+    // streams by offset, in the order of the streams within an offset
+    std::vector<uint32_t> order(fStreams);
+    for (uint32_t s = 0; s < fStreams; ++s)
+        order[s] = s;
+    std::stable_sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b) {
+        return fOffsets[a] < fOffsets[b];
+    });
+
+    fBlocks.clear();
+
+    for (size_t first = 0; first < order.size();) {
+        const double offset = fOffsets[order[first]];
+        size_t last = first;
+        while (last < order.size() && fOffsets[order[last]] == offset)
+            ++last;
+
+        // blocks of even sizes, rather than a full one and a remainder
+        size_t count = last - first;
+        size_t blocks = (count + blockStreams - 1) / blockStreams;
+        for (size_t b = 0; b < blocks; ++b) {
+            size_t begin = first + count * b / blocks;
+            size_t end = first + count * (b + 1) / blocks;
+
+            Block block;
+            block.core = fCore;
+            block.offset = offset;
+            block.streams.assign(order.begin() + begin, order.begin() + end);
+            block.history.resize(block.streams.size() * Core::historySize);
+            block.historyInt16.resize(block.streams.size() * Core::historySize);
+            fBlocks.push_back(std::move(block));
+        }
+
+        first = last;
+    }
+
+    clear();
+}
+
+template <uint32_t Ksize, uint32_t Ktable>
+void MultiStreamResampler<Ksize, Ktable>::process(const float *const in[], size_t inFrames, float *const out[], size_t outFrames, ResamplerCount counts[])
+{
+    processBlocks(in, inFrames, out, outFrames, counts);
+}
+
+template <uint32_t Ksize, uint32_t Ktable>
+void MultiStreamResampler<Ksize, Ktable>::process(const int16_t *const in[], size_t inFrames, int16_t *const out[], size_t outFrames, ResamplerCount counts[])
+{
+    processBlocks(in, inFrames, out, outFrames, counts);
+}
+
+template <uint32_t Ksize, uint32_t Ktable>
+template <class T>
+void MultiStreamResampler<Ksize, Ktable>::processBlocks(const T *const in[], size_t inFrames, T *const out[], size_t outFrames, ResamplerCount counts[])
+{
+    if (fBlocks.empty())
+        return;
+
+    const size_t tile = 16;
+    T *frames = scratch(in[0]);
+    T *blockOut[blockStreams];
+
+    for (Block &block : fBlocks) {
+        const uint32_t nch = (uint32_t)block.streams.size();
+        const uint32_t *streams = block.streams.data();
+
+        auto write = [&blockOut](size_t i, uint32_t c, T x) {
+            blockOut[c][i] = x;
+        };
+
+        // the input in chunks, transposed into interleaved frames which the
+        // core convolves in place
+        ResamplerCount count{0, 0};
+        if (block.silence > 0) {
+            count.produced = std::min(block.silence, outFrames);
+            for (uint32_t c = 0; c < nch; ++c)
+                std::fill(out[streams[c]], out[streams[c]] + count.produced, T(0));
+            block.silence -= count.produced;
+        }
+
+        for (bool more = true; more;) {
+            const size_t chunk = std::min(inFrames - count.consumed, (size_t)chunkFrames);
+            for (size_t i0 = 0; i0 < chunk; i0 += tile) {
+                const size_t i1 = std::min(i0 + tile, chunk);
+                for (uint32_t c = 0; c < nch; ++c) {
+                    const T *src = in[streams[c]] + count.consumed;
+                    for (size_t i = i0; i < i1; ++i)
+                        frames[i * nch + c] = src[i];
+                }
+            }
+
+            for (uint32_t c = 0; c < nch; ++c)
+                blockOut[c] = out[streams[c]] + count.produced;
+
+            ResamplerCount part = block.core.processFrames(
+                history(block, frames), nch, frames, chunk, write, outFrames - count.produced);
+            count.consumed += part.consumed;
+            count.produced += part.produced;
+            more = part.consumed == chunk && count.consumed < inFrames && count.produced < outFrames;
+        }
+
+        for (uint32_t c = 0; c < nch; ++c)
+            counts[streams[c]] = count;
+    }
+}
@@ -0,0 +1,28 @@
+#pragma once
+#include "dynamic_resampler.h"
+
+/**
+   Resample a whole buffer of interleaved frames, in parallel chunks.
+
+   The output is divided in chunks, each computed by a copy of `prototype`
+   positioned exactly on its first frame. Chunks run in parallel on the
+   OpenMP thread pool, if the program is built with OpenMP support.
+
+   The result is identical to the serial resampling of the whole buffer by
+   `prototype`, with the input continued by silence past its end.
+
+   `prototype` a resampler configured with its ratio and settings
+   `in` interleaved input frames
+   `inFrames` number of input frames
+   `out` interleaved output frames
+   `outFrames` number of output frames to compute
+   `chunkFrames` number of output frames per chunk
+ */
+template <uint32_t Ksize, uint32_t Ktable>
+void resampleParallel(
+    const DynamicResampler<Ksize, Ktable> &prototype,
+    const float *in, size_t inFrames,
+    float *out, size_t outFrames,
+    size_t chunkFrames = 64 * 1024);
+
+#include "parallel_resampler.tcc"
@@ -0,0 +1,40 @@
+#include "parallel_resampler.h"
+#include <vector>
+
+template <uint32_t Ksize, uint32_t Ktable>
+void resampleParallel(
+    const DynamicResampler<Ksize, Ktable> &prototype,
+    const float *in, size_t inFrames,
+    float *out, size_t outFrames,
+    size_t chunkFrames)
+{
+    const uint32_t nch = prototype.channels();
+    const long numChunks = (long)((outFrames + chunkFrames - 1) / chunkFrames);
+
+    #pragma omp parallel for schedule(dynamic)
+    for (long k = 0; k < numChunks; ++k) {
+        const size_t begin = (size_t)k * chunkFrames;
+        const size_t end = std::min(begin + chunkFrames, outFrames);
+
+        DynamicResampler<Ksize, Ktable> rsm(prototype);
+        size_t i_in = rsm.seek(begin);
+        size_t i_out = begin;
+
+        while (i_out < end && i_in < inFrames) {
+            ResamplerCount count = rsm.process(
+                in + i_in * nch, inFrames - i_in,
+                out + i_out * nch, end - i_out);
+            i_in += count.consumed;
+            i_out += count.produced;
+        }
+
+        // past the end of input, continue with silence
+        std::vector<float> silence;
+        while (i_out < end) {
+            silence.resize(256 * nch);
+            ResamplerCount count = rsm.process(
+                silence.data(), 256, out + i_out * nch, end - i_out);
+            i_out += count.produced;
+        }
+    }
+}
@@ -0,0 +1,311 @@
+#include "preset_resampler.h"
+#include "dynamic_resampler.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+ResamplerQuality ResamplerQuality::preset(ResamplerPreset preset)
+{
+    switch (preset) {
+    case ResamplerPreset::Low:
+        return ResamplerQuality{8, ResamplerWindow::Kaiser, 2.0};
+    case ResamplerPreset::Medium:
+        return ResamplerQuality{16, ResamplerWindow::Kaiser, 2.5};
+    case ResamplerPreset::Best:
+        return ResamplerQuality{64, ResamplerWindow::Kaiser, 3.0};
+    case ResamplerPreset::High:
+    default:
+        return ResamplerQuality{32, ResamplerWindow::Kaiser, 2.5};
+    }
+}
+
+//------------------------------------------------------------------------------
+
+class PresetResampler::Engine {
+public:
+    virtual ~Engine() {}
+
+    virtual uint32_t ksize() const = 0;
+    virtual void setup(double ratio) = 0;
+    virtual void setRatio(double ratio) = 0;
+    virtual bool setupRational(uint32_t inRate, uint32_t outRate) = 0;
+    virtual void setWindow(ResamplerWindow window, double alpha) = 0;
+    virtual void clear() = 0;
+
+    /**
+       Get or set the position of the next output frame.
+       (see `ResamplerCore::phase`)
+     */
+    virtual double phase() = 0;
+    virtual void setPhase(double phase) = 0;
+
+    virtual ResamplerCount process(const float *in, size_t inFrames, float *out, size_t outFrames) = 0;
+    virtual ResamplerCount processPlanar(const float *const in[], size_t inFrames, float *const out[], size_t outFrames) = 0;
+
+    virtual ResamplerStats stats() const = 0;
+    virtual void resetStats() = 0;
+
+    /**
+       Window of the kernel in use
+     */
+    ResamplerWindow window = ResamplerWindow::Kaiser;
+    double alpha = 2.5;
+};
+
+/**
+   Engine which runs a convolution resampler, interpolated between the rows
+   of a small table if not in rational mode
+ */
+template <uint32_t Ksize>
+class PresetResampler::SizedEngine : public PresetResampler::Engine {
+public:
+    explicit SizedEngine(uint32_t channels)
+        : fResampler(channels)
+    {
+        fResampler.core().setInterpolated(true);
+    }
+
+    uint32_t ksize() const override { return Ksize; }
+    void setup(double ratio) override { fResampler.setup(ratio); }
+    void setRatio(double ratio) override { fResampler.setRatio(ratio); }
+    bool setupRational(uint32_t inRate, uint32_t outRate) override { return fResampler.setupRational(inRate, outRate); }
+    void clear() override { fResampler.clear(); }
+    double phase() override { return fResampler.core().phase(); }
+    void setPhase(double phase) override { fResampler.core().setPhase(phase); }
+
+    void setWindow(ResamplerWindow window, double alpha) override
+    {
+        fResampler.core().setWindow(window, alpha);
+        this->window = window;
+        this->alpha = alpha;
+    }
+
+    ResamplerCount process(const float *in, size_t inFrames, float *out, size_t outFrames) override
+    {
+        return fResampler.process(in, inFrames, out, outFrames);
+    }
+
+    ResamplerCount processPlanar(const float *const in[], size_t inFrames, float *const out[], size_t outFrames) override
+    {
+        return fResampler.processPlanar(in, inFrames, out, outFrames);
+    }
+
+    ResamplerStats stats() const override { return fResampler.stats(); }
+    void resetStats() override { fResampler.resetStats(); }
+
+private:
+    DynamicResampler<Ksize, Ksize * 256> fResampler;
+};
+
+//------------------------------------------------------------------------------
+
+constexpr size_t PresetResampler::tailFrames;
+
+/**
+   Number of frames of the interleaved output of the tail, for the planar
+   output
+ */
+static const size_t scratchFrames = 256;
+
+PresetResampler::PresetResampler(uint32_t channels)
+    : fChannels(channels), fTail(tailFrames * channels), fScratch(scratchFrames * channels), fOut(channels)
+{
+    fEngines.emplace_back(new SizedEngine<8>(channels));
+    fEngines.emplace_back(new SizedEngine<16>(channels));
+    fEngines.emplace_back(new SizedEngine<32>(channels));
+    fEngines.emplace_back(new SizedEngine<64>(channels));
+
+    for (ResamplerPreset preset : {ResamplerPreset::Low, ResamplerPreset::Medium, ResamplerPreset::High, ResamplerPreset::Best}) {
+        ResamplerQuality quality = ResamplerQuality::preset(preset);
+        for (std::unique_ptr<Engine> &engine : fEngines) {
+            if (engine->ksize() == quality.ksize)
+                engine->setWindow(quality.window, quality.alpha);
+        }
+    }
+
+    fQuality = ResamplerQuality::preset(ResamplerPreset::High);
+    fEngine = fEngines[2].get();
+    fLatency = fEngine->ksize() / 2;
+}
+
+PresetResampler::~PresetResampler()
+{
+}
+
+void PresetResampler::setup(double ratio)
+{
+    for (std::unique_ptr<Engine> &engine : fEngines)
+        engine->setup(ratio);
+}
+
+void PresetResampler::setRatio(double ratio)
+{
+    for (std::unique_ptr<Engine> &engine : fEngines)
+        engine->setRatio(ratio);
+}
+
+bool PresetResampler::setupRational(uint32_t inRate, uint32_t outRate)
+{
+    bool rational = true;
+    for (std::unique_ptr<Engine> &engine : fEngines)
+        rational = engine->setupRational(inRate, outRate) && rational;
+    return rational;
+}
+
+void PresetResampler::setQuality(const ResamplerQuality &quality)
+{
+    Engine *engine = fEngines.back().get();
+    for (std::unique_ptr<Engine> &e : fEngines) {
+        if (e->ksize() >= quality.ksize) {
+            engine = e.get();
+            break;
+        }
+    }
+
+    if (engine->window != quality.window || engine->alpha != quality.alpha)
+        engine->setWindow(quality.window, quality.alpha);
+
+    if (engine != fEngine && !fStarted) {
+        engine->clear();
+        fEngine = engine;
+        fLatency = engine->ksize() / 2;
+    }
+    else if (engine != fEngine) {
+        // position of the next output relative to the last input frame,
+        // with the center of the new window where the previous one was
+        const double knew = engine->ksize();
+        const double kold = fEngine->ksize();
+        double position = fEngine->phase() - fPending + 0.5 * (knew - kold);
+
+        // the new window is filled with the frames of the tail, from enough
+        // frames back to compute the outputs which come before the last one
+        size_t frames = (size_t)knew + (size_t)std::max(0.0, std::ceil(-position));
+        frames = std::min(frames, tailFrames);
+
+        engine->clear();
+        engine->setPhase(position + frames);
+        fPending = frames;
+        fEngine = engine;
+    }
+
+    fQuality = quality;
+    fQuality.ksize = engine->ksize();
+}
+
+void PresetResampler::clear()
+{
+    fEngine->clear();
+    std::fill(fTail.begin(), fTail.end(), 0.0f);
+    fPending = 0;
+    fLatency = fEngine->ksize() / 2;
+    fStarted = false;
+}
+
+ResamplerCount PresetResampler::process(const float *in, size_t inFrames, float *out, size_t outFrames)
+{
+    size_t produced = processPending(out, outFrames);
+    if (fPending > 0)
+        return ResamplerCount{0, produced};
+
+    ResamplerCount count = fEngine->process(in, inFrames, out + produced * fChannels, outFrames - produced);
+    pushTail(in, count.consumed);
+    count.produced += produced;
+    fStarted = fStarted || count.consumed > 0 || count.produced > 0;
+    return count;
+}
+
+ResamplerCount PresetResampler::processPlanar(const float *const in[], size_t inFrames, float *const out[], size_t outFrames)
+{
+    const uint32_t nch = fChannels;
+
+    size_t produced = processPendingPlanar(out, outFrames);
+    if (fPending > 0)
+        return ResamplerCount{0, produced};
+
+    for (uint32_t c = 0; c < nch; ++c)
+        fOut[c] = out[c] + produced;
+
+    ResamplerCount count = fEngine->processPlanar(in, inFrames, fOut.data(), outFrames - produced);
+    pushTailPlanar(in, count.consumed);
+    count.produced += produced;
+    fStarted = fStarted || count.consumed > 0 || count.produced > 0;
+    return count;
+}
+
+ResamplerStats PresetResampler::stats() const
+{
+    ResamplerStats stats;
+    for (const std::unique_ptr<Engine> &engine : fEngines)
+        stats += engine->stats();
+    return stats;
+}
+
+void PresetResampler::resetStats()
+{
+    for (std::unique_ptr<Engine> &engine : fEngines)
+        engine->resetStats();
+}
+
+size_t PresetResampler::processPending(float *out, size_t outFrames)
+{
+    if (fPending == 0)
+        return 0;
+
+    const float *tail = &fTail[(tailFrames - fPending) * fChannels];
+    ResamplerCount count = fEngine->process(tail, fPending, out, outFrames);
+    fPending -= count.consumed;
+    return count.produced;
+}
+
+size_t PresetResampler::processPendingPlanar(float *const out[], size_t outFrames)
+{
+    const uint32_t nch = fChannels;
+    size_t produced = 0;
+
+    while (fPending > 0 && produced < outFrames) {
+        const float *tail = &fTail[(tailFrames - fPending) * nch];
+        size_t frames = std::min(outFrames - produced, scratchFrames);
+        ResamplerCount count = fEngine->process(tail, fPending, fScratch.data(), frames);
+
+        for (size_t i = 0; i < count.produced; ++i) {
+            for (uint32_t c = 0; c < nch; ++c)
+                out[c][produced + i] = fScratch[i * nch + c];
+        }
+
+        fPending -= count.consumed;
+        produced += count.produced;
+        if (count.consumed == 0 && count.produced == 0)
+            break;
+    }
+
+    return produced;
+}
+
+void PresetResampler::pushTail(const float *in, size_t frames)
+{
+    const uint32_t nch = fChannels;
+    float *tail = fTail.data();
+
+    if (frames >= tailFrames) {
+        std::memcpy(tail, in + (frames - tailFrames) * nch, tailFrames * nch * sizeof(float));
+        return;
+    }
+
+    std::memmove(tail, tail + frames * nch, (tailFrames - frames) * nch * sizeof(float));
+    std::memcpy(tail + (tailFrames - frames) * nch, in, frames * nch * sizeof(float));
+}
+
+void PresetResampler::pushTailPlanar(const float *const in[], size_t frames)
+{
+    const uint32_t nch = fChannels;
+    float *tail = fTail.data();
+
+    size_t kept = (frames < tailFrames) ? (tailFrames - frames) : 0;
+    size_t skipped = frames - (tailFrames - kept);
+    std::memmove(tail, tail + (tailFrames - kept) * nch, kept * nch * sizeof(float));
+
+    for (size_t i = kept; i < tailFrames; ++i) {
+        for (uint32_t c = 0; c < nch; ++c)
+            tail[i * nch + c] = in[c][skipped + i - kept];
+    }
+}
@@ -0,0 +1,186 @@
+#pragma once
+#include "resampler.h"
+#include <memory>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+/**
+   Quality tiers of `PresetResampler`, in increasing cost
+ */
+enum class ResamplerPreset {
+    Low,    // 8 taps
+    Medium, // 16 taps
+    High,   // 32 taps, the default of `Resampler`
+    Best,   // 64 taps
+};
+
+/**
+   Quality settings of `PresetResampler`
+ */
+struct ResamplerQuality {
+    /**
+       Convolution size: 8, 16, 32 or 64, otherwise rounded up to one of
+       them, and at most 64
+     */
+    uint32_t ksize;
+
+    /**
+       Window function, and parameter of the Kaiser window (beta = pi * alpha)
+     */
+    ResamplerWindow window;
+    double alpha;
+
+    /**
+       Get the settings of a preset.
+     */
+    static ResamplerQuality preset(ResamplerPreset preset);
+};
+
+/**
+   Convolution-based realtime resampler, with a quality selected at runtime
+
+   Every convolution size is a separate specialization of `ResamplerCore`,
+   and its kernel tables are built when the ratio is set up, so a service
+   can change the quality while running, to drop to a cheaper one under
+   load and to come back later.
+
+   A change of quality keeps the output continuous: the new convolution
+   starts from the last input frames, at the position where the previous
+   one stopped. So the latency is the one of the quality at the start of
+   the stream, and a smaller convolution only needs less input ahead.
+ */
+class PresetResampler {
+public:
+    /**
+       Create a resampler for the given number of channels, at the quality
+       `ResamplerPreset::High`.
+     */
+    explicit PresetResampler(uint32_t channels);
+    ~PresetResampler();
+
+    /**
+       Get the number of channels.
+     */
+    uint32_t channels() const { return fChannels; }
+
+    /**
+       Set the ratio of rate conversion: ratio = Fs_out/Fs_in.
+       The kernels of all the convolution sizes are ready after the call.
+     */
+    void setup(double ratio);
+
+    /**
+       Change the ratio of rate conversion in the middle of a stream.
+       (see `ResamplerCore::setRatio`)
+     */
+    void setRatio(double ratio);
+
+    /**
+       Set an exact ratio of rate conversion, from a pair of sample rates.
+       (see `ResamplerCore::setupRational`)
+     */
+    bool setupRational(uint32_t inRate, uint32_t outRate);
+
+    /**
+       Change the quality, in the middle of a stream or not.
+       A window other than the one of the preset of the same size has its
+       kernel built by this call.
+     */
+    void setQuality(const ResamplerQuality &quality);
+    void setQuality(ResamplerPreset preset) { setQuality(ResamplerQuality::preset(preset)); }
+
+    /**
+       Get the quality in use.
+     */
+    const ResamplerQuality &quality() const { return fQuality; }
+
+    /**
+       Reset the history and the fractional position, keeping the ratio and
+       the quality.
+     */
+    void clear();
+
+    /**
+       Compute resampled frames from a block of interleaved input.
+       (see `Resampler::process`)
+     */
+    ResamplerCount process(const float *in, size_t inFrames, float *out, size_t outFrames);
+
+    /**
+       Compute resampled frames from a block of planar input.
+       (see `Resampler::processPlanar`)
+     */
+    ResamplerCount processPlanar(const float *const in[], size_t inFrames, float *const out[], size_t outFrames);
+
+    /**
+       Get the latency introduced by this resampler, in frames.
+     */
+    uint32_t latency() const { return fLatency; }
+
+    /**
+       Get the performance counters of all the qualities, collected since
+       the creation or the last reset. The frames of the tail, which a change
+       of quality reads again, are counted again. (see `ResamplerCore::stats`)
+     */
+    ResamplerStats stats() const;
+    void resetStats();
+
+private:
+    /**
+       Resampler of one convolution size
+     */
+    class Engine;
+    template <uint32_t Ksize>
+    class SizedEngine;
+
+    /**
+       Read the frames left from the tail, after a change of quality.
+       Returns the count of output frames.
+     */
+    size_t processPending(float *out, size_t outFrames);
+    size_t processPendingPlanar(float *const out[], size_t outFrames);
+
+    /**
+       Keep the last frames of input, to restart from them.
+     */
+    void pushTail(const float *in, size_t frames);
+    void pushTailPlanar(const float *const in[], size_t frames);
+
+    /**
+       Number of frames kept from the input, enough for the largest size
+     */
+    static constexpr size_t tailFrames = 128;
+
+    uint32_t fChannels = 0;
+    ResamplerQuality fQuality;
+    uint32_t fLatency = 0;
+
+    /**
+       Whether frames were processed since the start of the stream
+     */
+    bool fStarted = false;
+
+    /**
+       One engine per convolution size, and the one in use
+     */
+    std::vector<std::unique_ptr<Engine>> fEngines;
+    Engine *fEngine = nullptr;
+
+    /**
+       Last input frames, interleaved, and the number of them which the
+       engine in use has still to read after a change of quality
+     */
+    std::vector<float> fTail;
+    size_t fPending = 0;
+
+    /**
+       Interleaved output of the tail, for the planar output
+     */
+    std::vector<float> fScratch;
+
+    /**
+       Planar output after the frames of the tail
+     */
+    std::vector<float *> fOut;
+};
@@ -1,7 +1,523 @@
 #pragma once
+#include "resampler_kernel.h"
+#include "resampler_stats.h"
 #include <array>
 #include <cmath>
+#include <cstddef>
 #include <cstdint>
+#include <type_traits>
+
+/**
+   Number of frames processed by a block operation
+ */
+struct ResamplerCount {
+    size_t consumed; // input frames
+    size_t produced; // output frames
+};
+
+/**
+   Channel-independent part of the convolution resampler
+
+   It holds the kernel, the fractional position and the resampling loop. The
+   history storage belongs to the caller, so the same loop serves a channel
+   count known at compile time or at runtime.
+
+   The history is `nch` consecutive arrays of `historySize` samples, or,
+   from `laneChannels` channels (`laneChannelsInt16` in 16-bit),
+   `historySize` consecutive frames of `nch` samples. Its size is the same in both layouts.
+
+   `Ksize` convolution size (higher = more quality, latency, computation)
+   `Ktable` length of the oversampled windowed sinc table
+ */
+template <uint32_t Ksize = 32, uint32_t Ktable = 128 * 1024>
+class ResamplerCore {
+public:
+    static_assert(
+        (Ktable % Ksize) == 0,
+        "The table size must be a multiple of the convolution size.");
+
+    /**
+       Oversampling factor of the lookup table
+       It is the number of divisions between zero crossings of windowed sinc.
+     */
+    static constexpr uint32_t Kover = Ktable / Ksize;
+
+    /**
+       Number of history samples per channel
+       The second part [Ksize:2*Ksize-1] is a duplicate of [0:Ksize-1].
+       (vectorization purposes)
+     */
+    static constexpr uint32_t historySize = 2 * Ksize;
+
+    /**
+       Unit of the phase outside of the rational mode, in 32.32 fixed point
+     */
+    static constexpr uint64_t phaseOne = uint64_t(1) << 32;
+
+    /**
+       Largest number of output frames computed together from the same
+       history window, when upsampling
+     */
+    static constexpr uint32_t batchSize = 4;
+
+    /**
+       Number of channels from which the history is stored frame-major.
+       The channels of a frame sit in adjacent SIMD lanes, and every kernel
+       coefficient multiplies all of them at once, without horizontal sums.
+     */
+    static constexpr uint32_t laneChannels = 8;
+
+    /**
+       Same for the 16-bit samples, whose multiply-add pairs two frames,
+       and wins over the horizontal sums only from more lanes
+     */
+    static constexpr uint32_t laneChannelsInt16 = 16;
+
+    ResamplerCore();
+
+    /**
+       Set the ratio of rate conversion: ratio = Fs_out/Fs_in.
+       When downsampling, the kernel cutoff follows the ratio, unless the
+       anti-aliasing is disabled.
+     */
+    void setup(double ratio);
+
+    /**
+       Change the ratio of rate conversion in the middle of a stream.
+       The position of the last output frame is kept, and the kernel design
+       is not changed, so it is cheap enough to call every block. It leaves
+       the rational mode.
+     */
+    void setRatio(double ratio);
+
+    /**
+       Set an exact ratio of rate conversion, from a pair of sample rates.
+       If the reduced ratio is L/M with L not more than `Kover`, the resampler
+       uses a bank of exactly L kernels, one per output phase, stepped with
+       integer counters. Otherwise it behaves like `setup(outRate / inRate)`.
+
+       Returns whether the rational mode is in use.
+     */
+    bool setupRational(uint32_t inRate, uint32_t outRate);
+
+    /**
+       Set whether the kernel is interpolated linearly between the rows of
+       the table, according to the fractional position. It permits to reduce
+       `Ktable` by orders of magnitude at the same quality.
+     */
+    void setInterpolated(bool interpolated) { fInterpolated = interpolated; }
+
+    /**
+       Set the window function of the kernel.
+       `alpha` is the parameter of the Kaiser window.
+     */
+    void setWindow(ResamplerWindow window, double alpha = 2.5);
+
+    /**
+       Set the phase response of the kernel. The minimum phase reduces the
+       latency to a few frames, for the live uses, with the same magnitude
+       response and the same cost.
+     */
+    void setResponse(ResamplerResponse response);
+
+    /**
+       Set the storage of the kernel table, to cut the memory traffic and
+       the cache footprint of the kernel fetch.
+
+       `format` with 16 bits, the table is half the size, and every row is
+       widened to floats before its convolution.
+       `folded` only the rows of the offsets up to one half are stored: the
+       others are their mirrors, shifted by one coefficient, which holds for
+       the linear phase only, and the convolution reads them backwards.
+
+       The rational mode and the fixed-point path keep their own tables.
+     */
+    void setStorage(ResamplerFormat format, bool folded = false);
+
+    /**
+       Set whether the kernel cutoff is lowered to the output Nyquist when
+       downsampling. Kernels are designed once per ratio for all the process.
+       It is enabled by default.
+     */
+    void setAntiAliasing(bool antiAliasing);
+
+    /**
+       Get the ratio of rate conversion.
+     */
+    double ratio() const { return (double)fPhaseOne / fPhaseIncr; }
+
+    /**
+       Get the size of the kernel table in use, in bytes.
+     */
+    size_t kernelBytes() const;
+
+    /**
+       Reset the fractional position, keeping the ratio.
+       The caller is responsible for zeroing the history.
+     */
+    void clear();
+
+    /**
+       Position the resampler on the output frame `outFrame`, as if all the
+       frames before it had been computed from the start of the stream.
+       The position is computed exactly with integers, so that the next
+       outputs are identical to a resampler which ran from the start.
+       The caller is responsible for zeroing the history.
+
+       Returns the index of the next input frame to pass, which is the
+       first of the frames to fill the history with.
+     */
+    uint64_t seek(uint64_t outFrame);
+
+    /**
+       Move the position of the next output frames by `frames` input frames,
+       which may be fractional: a positive shift takes the outputs later in
+       the input, so they lead by as much, and need as many more input
+       frames before them. In the rational mode, it is rounded to a phase of
+       the bank. The position does not go before the center of the history
+       window: a larger negative shift stops there.
+     */
+    void shift(double frames);
+
+    /**
+       Get the position of the next output frame, in input frames from the
+       center of the history window. The integer part is the number of
+       input frames to read before computing it.
+     */
+    double phase() const { return (double)fPhase / fPhaseOne; }
+
+    /**
+       Set the position of the next output frame. (see `phase`)
+       It is rounded to the resolution of the phase, and a negative one is
+       set to zero.
+     */
+    void setPhase(double phase);
+
+    /**
+       Get the number of output frames computed from the next `inFrames`
+       input frames, when the output is not limited: the ones which are
+       ready after reading all of them.
+       The count is exact, as long as the ratio does not change.
+     */
+    uint64_t outputsFor(uint64_t inFrames) const;
+
+    /**
+       Get the smallest number of input frames to read for computing the
+       next `outFrames` output frames.
+       Reading exactly as many may make more output frames ready.
+       (see `outputsFor`)
+     */
+    uint64_t inputsFor(uint64_t outFrames) const;
+
+    /**
+       Compute resampled frames from a block of interleaved input.
+       The sample type `T` is float, or int16_t for the fixed-point path.
+     */
+    template <class T, class Ch>
+    ResamplerCount process(T *history, Ch nch, const T *in, size_t inFrames, T *out, size_t outFrames);
+
+    /**
+       Compute resampled frames from a block of interleaved input, into any
+       output storage.
+       `write(i, c, x)` stores `x` into channel `c` of the output frame `i`
+     */
+    template <class T, class Ch, class W>
+    ResamplerCount processFrames(T *history, Ch nch, const T *in, size_t inFrames, const W &write, size_t outFrames);
+
+    /**
+       Compute resampled frames from a block of planar input.
+
+       The outputs are convolved directly over the input buffers, except
+       the first ones of the block, which need frames of the history: the
+       history is not written for every input frame, but only once per block
+       with its last frames. Mono interleaved input, and interleaved input
+       in the frame-major layout, take the same path. Blocks shorter than
+       `Ksize` go through the history.
+     */
+    template <class T, class Ch>
+    ResamplerCount processPlanar(T *history, Ch nch, const T *const in[], size_t inFrames, T *const out[], size_t outFrames);
+
+    /**
+       Run the resampling loop.
+
+       The fixed-point path, selected by a history of int16_t, convolves
+       16-bit samples with the kernel quantized to Q15, in 32-bit integer
+       accumulators, and rounds the results with saturation.
+
+       When upsampling, the outputs which fall before the next input frame
+       share the history window: they are computed in batches of up to
+       `batchSize`, with one pass over the window for all of them. Their
+       channels are written in order, but a batch writes every frame of a
+       channel before the next channel.
+
+       `history` storage for the history of all channels
+       `nch` number of channels, an integer or std::integral_constant
+       `read(i, c)` returns the channel `c` of the input frame `i`
+       `write(i, c, x)` stores `x` into channel `c` of the output frame `i`
+     */
+    template <class T, class Ch, class R, class W>
+    ResamplerCount run(T *history, Ch nch, const R &read, size_t inFrames, const W &write, size_t outFrames);
+
+    /**
+       Get the group delay of the kernel at low frequencies, in input frames.
+       (see `ResamplerKernel::delay`)
+     */
+    double delay() const { return fDelay; }
+
+    /**
+       Get the latency introduced by this resampler, in whole input frames:
+       the delay rounded to the nearest frame, which is `Ksize / 2` for the
+       linear phase. The delay of a minimum-phase kernel is fractional, and
+       `delay` gives it exactly.
+     */
+    uint32_t latency() const { return (uint32_t)std::lround(fDelay); }
+
+    /**
+       Get the performance counters, collected since the creation or the
+       last reset. (see `ResamplerStats`)
+     */
+    ResamplerStats stats() const { return fCounters.stats(); }
+    void resetStats() { fCounters.reset(); }
+
+    /**
+       Access the hooks of the instrumentation, for the callers which time
+       their callbacks.
+     */
+    ResamplerCounters &counters() { return fCounters; }
+
+private:
+    /**
+       Run the resampling loop over contiguous input, one buffer per channel.
+       (see `processPlanar`)
+     */
+    template <class T, class Ch, class W>
+    ResamplerCount runDirect(T *history, Ch nch, const T *const in[], size_t inFrames, const W &write, size_t outFrames);
+
+    /**
+       Run the resampling loop over interleaved input, in the frame-major
+       layout. (see `processPlanar`)
+     */
+    template <class T, class Ch, class W>
+    ResamplerCount runDirectLanes(T *history, Ch nch, const T *in, size_t inFrames, const W &write, size_t outFrames);
+
+    /**
+       Run the resampling loop, whatever the storage of the input.
+
+       `ingest(i)` makes the input frame `i` the last of the window
+       `emit(rows, reversed, count, i)` computes `count` output frames from
+       `i`, with the kernel rows `rows`, padded to `batchSize`, and read
+       backwards where `reversed` (see `storedRow`)
+     */
+    template <class T, class I, class E>
+    ResamplerCount loop(const I &ingest, const E &emit, size_t inFrames, size_t outFrames);
+
+    /**
+       Get whether the history of `nch` channels is frame-major.
+     */
+    template <class Ch>
+    static bool channelLanes(const float *, Ch nch) { return nch >= laneChannels; }
+    template <class Ch>
+    static bool channelLanes(const int16_t *, Ch nch) { return nch >= laneChannelsInt16; }
+
+    /**
+       Push the input frame `i` into the history.
+     */
+    template <class T, class Ch, class R>
+    static void ingest(T *history, Ch nch, uint32_t &historyIndex, const R &read, size_t i);
+
+    /**
+       Push the input frame `i` into the frame-major history.
+     */
+    template <class T, class Ch, class R>
+    static void ingestLanes(T *history, Ch nch, uint32_t &historyIndex, const R &read, size_t i);
+
+    /**
+       Convolve the windows with `count` kernel rows, into the output frames
+       from `i`, one row at a time or in a batch.
+     */
+    template <class T, class Ch, class V, class W>
+    static void convolveRows(Ch nch, const V &window, const T *const rows[], const bool reversed[], uint32_t count, const W &write, size_t i);
+
+    /**
+       Convolve the windows with a kernel row, into the output frame `i`.
+       A reversed row is read backwards, from its last coefficient.
+     */
+    template <class Ch, class V, class W>
+    static void convolve(Ch nch, const V &window, const float *row, bool reversed, const W &write, size_t i);
+    template <class Ch, class V, class W>
+    static void convolve(Ch nch, const V &window, const int16_t *row, bool reversed, const W &write, size_t i);
+
+    /**
+       Convolve the windows with `count` kernel rows, into the output frames
+       from `i`. The arrays `rows` and `reversed` are padded to `batchSize`.
+     */
+    template <class Ch, class V, class W>
+    static void convolveBatch(Ch nch, const V &window, const float *const rows[], const bool reversed[], uint32_t count, const W &write, size_t i);
+    template <class Ch, class V, class W>
+    static void convolveBatch(Ch nch, const V &window, const int16_t *const rows[], const bool reversed[], uint32_t count, const W &write, size_t i);
+
+    /**
+       Convolve the frame-major window `frames` with `count` kernel rows,
+       into the output frames from `i`.
+     */
+    template <class Ch, class W>
+    static void convolveLanes(Ch nch, const float *frames, const float *const rows[], const bool reversed[], uint32_t count, const W &write, size_t i);
+    template <class Ch, class W>
+    static void convolveLanes(Ch nch, const int16_t *frames, const int16_t *const rows[], const bool reversed[], uint32_t count, const W &write, size_t i);
+
+    /**
+       Round a Q15 accumulator to a 16-bit sample, with saturation.
+     */
+    static int16_t roundQ15(int32_t acc);
+
+    /**
+       Get the kernel row for a phase less than one input frame.
+       `buffer` receives the row if it needs to be computed, and `reversed`
+       whether it is read backwards. (see `storedRow`)
+     */
+    const float *kernelRow(uint64_t phase, float *buffer, bool &reversed) const;
+    const int16_t *kernelRow(uint64_t phase, int16_t *buffer, bool &reversed) const;
+
+    /**
+       Get the kernel row for the position `pos` in the table, in 32.32
+       fixed point, from the compact storage.
+     */
+    const float *compactRow(uint64_t pos, float *buffer, bool &reversed) const;
+
+    /**
+       Get the row `o` of the table, from the compact storage.
+       `buffer` receives the row if it needs to be widened.
+
+       A mirrored row is the stored row of the offset 1 - x, `reversed`: the
+       coefficient `i` of the row is the one `Ksize - i` of the stored row,
+       and the coefficient 0 is zero. So the convolution reads the stored
+       row backwards, from its coefficient 1, with the window from its
+       coefficient 1.
+     */
+    const float *storedRow(uint32_t o, float *buffer, bool &reversed) const;
+
+    /**
+       Fetch the kernel tables of the sample type, if not done yet.
+     */
+    void prepareKernel(const float *);
+    void prepareKernel(const int16_t *);
+
+    /**
+       Get the design of the bank of the rational mode.
+     */
+    ResamplerKernelSpec bankSpec() const;
+
+    /**
+       Set the kernel cutoff according to the ratio, and fetch the tables.
+     */
+    void updateKernel(double ratio);
+
+    /**
+       Advance a position by `count` increments of the phase, as integer
+       frames and a phase less than one frame.
+     */
+    void advance(uint64_t count, uint64_t &frames, uint64_t &phase) const;
+
+    /**
+       Change the unit and the increment of the phase, keeping the position
+       of the previous output frame.
+     */
+    void updatePhase(uint64_t one, uint64_t incr);
+
+    /**
+       Unit of the phase: one input frame is `fPhaseOne`.
+       It is `phaseOne`, or L in the rational mode.
+     */
+    uint64_t fPhaseOne = phaseOne;
+
+    /**
+       Increment of the phase every output frame
+     */
+    uint64_t fPhaseIncr = phaseOne;
+
+    /**
+       Phase of the next output frame over input signal
+       If it is `fPhaseOne` or more, input frames must be read before the output.
+     */
+    uint64_t fPhase = phaseOne;
+
+    /**
+       The history index points into the storage to the last Ksize samples of
+       signal.
+     */
+    uint32_t fHistoryIndex = 0;
+
+    /**
+       Design of the kernel
+     */
+    ResamplerKernelSpec fKernelSpec;
+
+    /**
+       Matrix of convolution kernels, of Kover + 1 rows and Ksize columns
+       Each row is for a different fractional offset (0 <= frac <= 1).
+       It is shared with all resamplers of the same design.
+       Folded, it has only the rows up to Kover / 2, and it is null when the
+       16-bit table is in use.
+     */
+    const float *fKernel = nullptr;
+
+    /**
+       Group delay of the kernel in use
+     */
+    double fDelay = 0;
+
+    /**
+       Storage of the table: format of the coefficients, whether it is
+       folded, and whether the rows above one half are actually mirrored
+     */
+    ResamplerFormat fFormat = ResamplerFormat::Float32;
+    bool fFolded = false;
+    bool fMirrored = false;
+
+    /**
+       Whether the rows are read from the compact storage
+     */
+    bool fCompact = false;
+
+    /**
+       Table in the 16-bit format, if it is in use
+     */
+    const uint16_t *fKernel16 = nullptr;
+
+    /**
+       Whether the kernel is interpolated between table rows
+     */
+    bool fInterpolated = false;
+
+    /**
+       Whether the kernel cutoff follows the ratio when downsampling
+     */
+    bool fAntiAliasing = true;
+
+    /**
+       Whether the rational mode is in use
+     */
+    bool fRational = false;
+
+    /**
+       Rational mode: bank of L kernel rows, of Ksize columns
+       It is shared with all resamplers of the same design and ratio.
+     */
+    const float *fBank = nullptr;
+
+    /**
+       Q15 versions of the kernel and of the bank, for the fixed-point path
+       They are fetched on first use, so that the float path does not pay
+       for them.
+     */
+    const int16_t *fKernelQ15 = nullptr;
+    const int16_t *fBankQ15 = nullptr;
+
+    /**
+       Performance counters, empty unless the instrumentation is enabled
+     */
+    ResamplerCounters fCounters;
+};
 
 /**
    Convolution-based realtime resampler
@@ -16,20 +532,35 @@
 template <uint32_t Nch, uint32_t Ksize = 32, uint32_t Ktable = 128 * 1024>
 class Resampler {
 public:
-    static_assert(
-        (Ktable % Ksize) == 0,
-        "The table size must be a multiple of the convolution size.");
+    typedef ResamplerCore<Ksize, Ktable> Core;
 
     /**
        Oversampling factor of the lookup table
        It is the number of divisions between zero crossings of windowed sinc.
      */
-    static constexpr uint32_t Kover = Ktable / Ksize;
+    static constexpr uint32_t Kover = Core::Kover;
 
     /**
        Set the ratio of rate conversion: ratio = Fs_out/Fs_in.
      */
-    void setup(double ratio);
+    void setup(double ratio) { fCore.setup(ratio); }
+
+    /**
+       Change the ratio of rate conversion in the middle of a stream.
+       (see `ResamplerCore::setRatio`)
+     */
+    void setRatio(double ratio) { fCore.setRatio(ratio); }
+
+    /**
+       Set an exact ratio of rate conversion, from a pair of sample rates.
+       (see `ResamplerCore::setupRational`)
+     */
+    bool setupRational(uint32_t inRate, uint32_t outRate) { return fCore.setupRational(inRate, outRate); }
+
+    /**
+       Reset the history and the fractional position, keeping the ratio.
+     */
+    void clear();
 
     /**
        Compute the next resampled block.
@@ -42,44 +573,135 @@ public:
     void resample(const G &getNext, const P &putNext, uint32_t putCount);
 
     /**
-       Get the latency introduced by this resampler, in frames.
+       Reset the resampler, and position it on the output frame `outFrame`.
+       (see `ResamplerCore::seek`)
      */
-    constexpr uint32_t latency() const { return Ksize / 2; }
+    uint64_t seek(uint64_t outFrame)
+    {
+        fHistory.fill(0);
+        fHistoryInt16.fill(0);
+        return fCore.seek(outFrame);
+    }
 
-private:
-    typedef std::array<float, Ksize> Krow;
-    typedef std::array<Krow, Kover> Kmat;
+    /**
+       Compute resampled frames from a block of interleaved input.
+       It stops when the output is full, or when the input is exhausted.
+       Frames not consumed must be passed again to the next call.
+
+       `in` interleaved input frames
+       `inFrames` number of input frames available
+       `out` interleaved output frames
+       `outFrames` number of output frames requested
+     */
+    ResamplerCount process(const float *in, size_t inFrames, float *out, size_t outFrames)
+    {
+        return fCore.process(fHistory.data(), Channels(), in, inFrames, out, outFrames);
+    }
 
     /**
-       Matrix of convolution kernels, of Kover rows and Ksize columns
-       It is a kernel of size (Kover x Ksize) stored in column-major order.
-       Each row is for a different fractional offset (0 <= frac < 1).
+       Compute resampled frames from a block of planar input.
+       It behaves like `process`, with one buffer per channel.
      */
-    static const Kmat sKernel;
-    static Kmat makeKernel();
+    ResamplerCount processPlanar(const float *const in[], size_t inFrames, float *const out[], size_t outFrames)
+    {
+        return fCore.processPlanar(fHistory.data(), Channels(), in, inFrames, out, outFrames);
+    }
 
     /**
-       Increment of the fractional input position every output frame
+       Compute resampled frames from a block of interleaved input, reading
+       all of it, for a stream driven by its input.
+       Returns the number of output frames, which is `outputsFor(inFrames)`.
+
+       `in` interleaved input frames
+       `inFrames` number of input frames
+       `out` interleaved output frames, with room for `outputsFor(inFrames)`
      */
-    double fIncrPos = 1;
+    size_t push(const float *in, size_t inFrames, float *out)
+    {
+        return process(in, inFrames, out, SIZE_MAX).produced;
+    }
 
     /**
-       Current fractional position over input signal
+       Compute resampled frames from a block of planar input, reading all
+       of it. (see `push`)
      */
-    double fFracPos = 0;
+    size_t pushPlanar(const float *const in[], size_t inFrames, float *const out[])
+    {
+        return processPlanar(in, inFrames, out, SIZE_MAX).produced;
+    }
 
     /**
-       The history index points into the storage to the last Ksize samples of
-       signal.
+       Compute resampled frames from a block of interleaved 16-bit input,
+       in fixed point. (see `ResamplerCore::run`)
+       The 16-bit and float paths have separate histories: a stream must
+       use one or the other.
      */
-    uint32_t fHistoryIndex = 0;
+    ResamplerCount process(const int16_t *in, size_t inFrames, int16_t *out, size_t outFrames)
+    {
+        return fCore.process(fHistoryInt16.data(), Channels(), in, inFrames, out, outFrames);
+    }
 
     /**
-       Storage for a history of Ksize samples
-       The second part [Ksize:2*Ksize-1] is a duplicate of [0:Ksize-1].
-       (vectorization purposes)
+       Compute resampled frames from a block of planar 16-bit input, in
+       fixed point.
+     */
+    ResamplerCount processPlanar(const int16_t *const in[], size_t inFrames, int16_t *const out[], size_t outFrames)
+    {
+        return fCore.processPlanar(fHistoryInt16.data(), Channels(), in, inFrames, out, outFrames);
+    }
+
+    /**
+       Compute resampled frames from a block of 16-bit input, reading all of
+       it, in fixed point. (see `push`)
+     */
+    size_t push(const int16_t *in, size_t inFrames, int16_t *out)
+    {
+        return process(in, inFrames, out, SIZE_MAX).produced;
+    }
+    size_t pushPlanar(const int16_t *const in[], size_t inFrames, int16_t *const out[])
+    {
+        return processPlanar(in, inFrames, out, SIZE_MAX).produced;
+    }
+
+    /**
+       Get the number of output frames of the next input frames, or the
+       reverse. (see `ResamplerCore::outputsFor` and `ResamplerCore::inputsFor`)
+     */
+    uint64_t outputsFor(uint64_t inFrames) const { return fCore.outputsFor(inFrames); }
+    uint64_t inputsFor(uint64_t outFrames) const { return fCore.inputsFor(outFrames); }
+
+    /**
+       Get the latency introduced by this resampler, in whole input frames.
+       (see `ResamplerCore::latency`)
+     */
+    uint32_t latency() const { return fCore.latency(); }
+
+    /**
+       Get the performance counters, collected since the creation or the
+       last reset. (see `ResamplerCore::stats`)
+     */
+    ResamplerStats stats() const { return fCore.stats(); }
+    void resetStats() { fCore.resetStats(); }
+
+    /**
+       Access the core, for the advanced settings.
+     */
+    Core &core() { return fCore; }
+
+private:
+    typedef std::integral_constant<uint32_t, Nch> Channels;
+
+    Core fCore;
+
+    /**
+       Storage for a history of Ksize samples, for each channel
+     */
+    std::array<float, Nch * Core::historySize> fHistory = {};
+
+    /**
+       Storage for the history of the 16-bit path
      */
-    std::array<float, 2 * Ksize> fHistory[Nch] = {};
+    std::array<int16_t, Nch * Core::historySize> fHistoryInt16 = {};
 };
 
 #include "resampler.tcc"
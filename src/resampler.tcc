@@ -1,107 +1,767 @@
 #include "resampler.h"
-#include "resampler_math.h"
+#include "resampler_simd.h"
+#include <algorithm>
 #include <cmath>
+#include <cstring>
 
-using namespace ResamplerMath;
+template <uint32_t Ksize, uint32_t Ktable>
+ResamplerCore<Ksize, Ktable>::ResamplerCore()
+{
+    fKernelSpec.size = Ksize;
+    fKernelSpec.rows = Kover;
+    fKernelSpec.window = ResamplerWindow::Kaiser;
+    fKernelSpec.alpha = 2.5;
+    fKernelSpec.cutoff = 1;
+    fKernelSpec.response = ResamplerResponse::LinearPhase;
+    fDelay = ResamplerKernel::delay(fKernelSpec);
+}
+
+template <uint32_t Ksize, uint32_t Ktable>
+void ResamplerCore<Ksize, Ktable>::setup(double ratio)
+{
+    bool wasRational = fRational;
 
-template <uint32_t Nch, uint32_t Ksize, uint32_t Kover>
-const typename Resampler<Nch, Ksize, Kover>::Kmat Resampler<Nch, Ksize, Kover>::sKernel = makeKernel();
+    updatePhase(phaseOne, (uint64_t)std::llround(phaseOne / ratio));
+    fRational = false;
 
-template <uint32_t Nch, uint32_t Ksize, uint32_t Kover>
-void Resampler<Nch, Ksize, Kover>::setup(double ratio)
+    double cutoff = (fAntiAliasing && ratio < 1) ? ratio : 1;
+    if (wasRational || cutoff != fKernelSpec.cutoff || (!fKernel && !fKernel16))
+        updateKernel(ratio);
+}
+
+template <uint32_t Ksize, uint32_t Ktable>
+void ResamplerCore<Ksize, Ktable>::setRatio(double ratio)
 {
-    fIncrPos = 1.0 / ratio;
+    updatePhase(phaseOne, (uint64_t)std::llround(phaseOne / ratio));
+
+    if (fRational) {
+        fRational = false;
+        fBank = nullptr;
+        fBankQ15 = nullptr;
+    }
 }
 
-template <uint32_t Nch, uint32_t Ksize, uint32_t Kover>
-template <class G, class P>
-void Resampler<Nch, Ksize, Kover>::resample(const G &getNext, const P &putNext, uint32_t putCount)
+template <uint32_t Ksize, uint32_t Ktable>
+bool ResamplerCore<Ksize, Ktable>::setupRational(uint32_t inRate, uint32_t outRate)
 {
-    double incrPos = fIncrPos;
-    double fracPos = fFracPos;
-    uint32_t historyIndex = fHistoryIndex;
+    uint32_t a = inRate;
+    uint32_t b = outRate;
+    while (b != 0) {
+        uint32_t t = a % b;
+        a = b;
+        b = t;
+    }
 
-    for (uint32_t i = 0; i < putCount; ++i) {
-        fracPos += incrPos;
+    uint32_t phases = (a != 0) ? (outRate / a) : 0;
+    uint32_t phaseIncr = (a != 0) ? (inRate / a) : 0;
 
-        while (fracPos >= 1.0) {
-            std::array<float, Nch> next;
-            getNext(next.data());
+    if (phases == 0 || phaseIncr == 0 || phases > Kover) {
+        setup((double)outRate / inRate);
+        return false;
+    }
 
-            for (uint32_t c = 0; c < Nch; ++c) {
-                std::array<float, 2 * Ksize> &hist = fHistory[c];
-                hist[historyIndex] = next[c];
-                hist[historyIndex + Ksize] = next[c];
-            }
+    updatePhase(phases, phaseIncr);
+    fRational = true;
 
-            historyIndex = (historyIndex + 1) % Ksize;
-            fracPos -= 1.0;
-        }
+    updateKernel((double)outRate / inRate);
+    return true;
+}
 
-        const Krow &row = sKernel[(uint32_t)(fracPos * Kover)];
+template <uint32_t Ksize, uint32_t Ktable>
+void ResamplerCore<Ksize, Ktable>::setWindow(ResamplerWindow window, double alpha)
+{
+    fKernelSpec.window = window;
+    fKernelSpec.alpha = alpha;
+    fKernelSpec = ResamplerKernel::normalize(fKernelSpec);
+    updateKernel(ratio());
+}
 
-        std::array<float, Nch> out;
+template <uint32_t Ksize, uint32_t Ktable>
+void ResamplerCore<Ksize, Ktable>::setResponse(ResamplerResponse response)
+{
+    fKernelSpec.response = response;
+    updateKernel(ratio());
+}
 
-        for (uint32_t c = 0; c < Nch; ++c) {
-            std::array<float, 2 * Ksize> &hist = fHistory[c];
-            float s = 0;
-            for (uint32_t i = 0; i < Ksize; ++i)
-                s += row[i] * hist[historyIndex + i];
-            out[c] = s;
-        }
+template <uint32_t Ksize, uint32_t Ktable>
+void ResamplerCore<Ksize, Ktable>::setStorage(ResamplerFormat format, bool folded)
+{
+    fFormat = format;
+    fFolded = folded;
+    updateKernel(ratio());
+}
+
+template <uint32_t Ksize, uint32_t Ktable>
+void ResamplerCore<Ksize, Ktable>::setAntiAliasing(bool antiAliasing)
+{
+    fAntiAliasing = antiAliasing;
+    updateKernel(ratio());
+}
+
+template <uint32_t Ksize, uint32_t Ktable>
+void ResamplerCore<Ksize, Ktable>::updateKernel(double ratio)
+{
+    fKernelSpec.cutoff = (fAntiAliasing && ratio < 1) ? ratio : 1;
+    fBank = fRational ? ResamplerKernel::table(bankSpec()) : nullptr;
+    fDelay = ResamplerKernel::delay(fRational ? bankSpec() : fKernelSpec);
+
+    // only the table of the storage in use is built
+    fMirrored = fFolded && fKernelSpec.response == ResamplerResponse::LinearPhase;
+    if (fFormat != ResamplerFormat::Float32) {
+        fKernel16 = ResamplerKernel::table16(fKernelSpec, fFormat, fMirrored);
+        fKernel = nullptr;
+    }
+    else {
+        fKernel16 = nullptr;
+        fKernel = ResamplerKernel::table(fKernelSpec, fMirrored);
+    }
+    fCompact = fKernel16 || fMirrored;
+
+    fKernelQ15 = nullptr;
+    fBankQ15 = nullptr;
+}
+
+template <uint32_t Ksize, uint32_t Ktable>
+void ResamplerCore<Ksize, Ktable>::prepareKernel(const float *)
+{
+    // the table is built by the setup, or on first use without one, for
+    // the design in place: a cutoff is the ratio which gives it back
+    if (!fKernel && !fKernel16)
+        updateKernel(fKernelSpec.cutoff);
+}
+
+template <uint32_t Ksize, uint32_t Ktable>
+void ResamplerCore<Ksize, Ktable>::prepareKernel(const int16_t *)
+{
+    if (!fKernelQ15)
+        fKernelQ15 = ResamplerKernel::tableQ15(fKernelSpec);
+    if (fRational && !fBankQ15)
+        fBankQ15 = ResamplerKernel::tableQ15(bankSpec());
+}
+
+template <uint32_t Ksize, uint32_t Ktable>
+ResamplerKernelSpec ResamplerCore<Ksize, Ktable>::bankSpec() const
+{
+    ResamplerKernelSpec spec = fKernelSpec;
+    spec.rows = (uint32_t)fPhaseOne;
+    return spec;
+}
+
+template <uint32_t Ksize, uint32_t Ktable>
+void ResamplerCore<Ksize, Ktable>::updatePhase(uint64_t one, uint64_t incr)
+{
+    // position of the previous output frame, relative to the history
+    // (negative if input frames were read since)
+    int64_t last = (int64_t)fPhase - (int64_t)fPhaseIncr;
+    if (one != fPhaseOne)
+        last = std::llround((double)last * one / fPhaseOne);
+
+    int64_t phase = last + (int64_t)incr;
+    fPhase = (phase > 0) ? (uint64_t)phase : 0;
+    fPhaseOne = one;
+    fPhaseIncr = incr;
+}
+
+template <uint32_t Ksize, uint32_t Ktable>
+size_t ResamplerCore<Ksize, Ktable>::kernelBytes() const
+{
+    if (fRational)
+        return fPhaseOne * Ksize * sizeof(float);
+
+    size_t rows = fMirrored ? (Kover / 2 + 1) : (Kover + 1);
+    return rows * Ksize * (fKernel16 ? sizeof(uint16_t) : sizeof(float));
+}
+
+template <uint32_t Ksize, uint32_t Ktable>
+void ResamplerCore<Ksize, Ktable>::clear()
+{
+    fPhase = fPhaseIncr;
+    fHistoryIndex = 0;
+}
+
+template <uint32_t Ksize, uint32_t Ktable>
+uint64_t ResamplerCore<Ksize, Ktable>::seek(uint64_t outFrame)
+{
+    const uint64_t one = fPhaseOne;
+
+    clear();
+
+    uint64_t phase = fPhase % one;
+    uint64_t consumed = fPhase / one;
+    advance(outFrame, consumed, phase);
 
-        putNext(out.data());
+    // read again the frames which fill the history
+    uint64_t refill = (consumed < Ksize) ? consumed : Ksize;
+    fPhase = phase + refill * one;
+    return consumed - refill;
+}
+
+template <uint32_t Ksize, uint32_t Ktable>
+void ResamplerCore<Ksize, Ktable>::advance(uint64_t count, uint64_t &frames, uint64_t &phase) const
+{
+    const uint64_t one = fPhaseOne;
+    const uint64_t incrFrames = fPhaseIncr / one;
+    const uint64_t incrPhase = fPhaseIncr % one;
+
+    // advance by steps small enough to not overflow
+    for (uint64_t n = count; n > 0;) {
+        uint64_t m = (n < (uint64_t(1) << 31)) ? n : (uint64_t(1) << 31);
+        phase += m * incrPhase;
+        frames += m * incrFrames + phase / one;
+        phase %= one;
+        n -= m;
+    }
+}
+
+template <uint32_t Ksize, uint32_t Ktable>
+uint64_t ResamplerCore<Ksize, Ktable>::outputsFor(uint64_t inFrames) const
+{
+    // the outputs are the ones before the phase of the frame after the
+    // input: estimate their count, and correct it to the exact one
+    double distance = (double)(inFrames + 1) * fPhaseOne - (double)fPhase;
+    uint64_t count = (distance > 0) ? (uint64_t)std::ceil(distance / fPhaseIncr) : 0;
+
+    while (count > 0 && inputsFor(count) > inFrames)
+        --count;
+    while (inputsFor(count + 1) <= inFrames)
+        ++count;
+    return count;
+}
+
+template <uint32_t Ksize, uint32_t Ktable>
+uint64_t ResamplerCore<Ksize, Ktable>::inputsFor(uint64_t outFrames) const
+{
+    if (outFrames == 0)
+        return 0;
+
+    // the last output is `outFrames - 1` increments after the next one,
+    // and it needs the input frames of the integer part of its phase
+    uint64_t phase = fPhase % fPhaseOne;
+    uint64_t frames = fPhase / fPhaseOne;
+    advance(outFrames - 1, frames, phase);
+    return frames;
+}
+
+template <uint32_t Ksize, uint32_t Ktable>
+void ResamplerCore<Ksize, Ktable>::shift(double frames)
+{
+    int64_t phase = (int64_t)fPhase + std::llround(frames * fPhaseOne);
+    fPhase = (phase > 0) ? (uint64_t)phase : 0;
+}
+
+template <uint32_t Ksize, uint32_t Ktable>
+void ResamplerCore<Ksize, Ktable>::setPhase(double phase)
+{
+    int64_t position = std::llround(phase * fPhaseOne);
+    fPhase = (position > 0) ? (uint64_t)position : 0;
+}
+
+template <uint32_t Ksize, uint32_t Ktable>
+template <class T, class Ch>
+ResamplerCount ResamplerCore<Ksize, Ktable>::process(T *history, Ch nch, const T *in, size_t inFrames, T *out, size_t outFrames)
+{
+    auto write = [out, nch](size_t i, uint32_t c, T x) {
+        out[i * nch + c] = x;
+    };
+
+    return processFrames(history, nch, in, inFrames, write, outFrames);
+}
+
+template <uint32_t Ksize, uint32_t Ktable>
+template <class T, class Ch, class W>
+ResamplerCount ResamplerCore<Ksize, Ktable>::processFrames(T *history, Ch nch, const T *in, size_t inFrames, const W &write, size_t outFrames)
+{
+    auto read = [in, nch](size_t i, uint32_t c) -> T {
+        return in[i * nch + c];
+    };
+
+    if (inFrames >= Ksize) {
+        if (channelLanes(history, nch))
+            return runDirectLanes(history, nch, in, inFrames, write, outFrames);
+        if (nch == 1)
+            return runDirect(history, nch, &in, inFrames, write, outFrames);
+    }
+
+    return run(history, nch, read, inFrames, write, outFrames);
+}
+
+template <uint32_t Ksize, uint32_t Ktable>
+template <class T, class Ch>
+ResamplerCount ResamplerCore<Ksize, Ktable>::processPlanar(T *history, Ch nch, const T *const in[], size_t inFrames, T *const out[], size_t outFrames)
+{
+    auto read = [in](size_t i, uint32_t c) -> T {
+        return in[c][i];
+    };
+    auto write = [out](size_t i, uint32_t c, T x) {
+        out[c][i] = x;
+    };
+
+    if (inFrames >= Ksize && !channelLanes(history, nch))
+        return runDirect(history, nch, in, inFrames, write, outFrames);
+
+    return run(history, nch, read, inFrames, write, outFrames);
+}
+
+template <uint32_t Ksize, uint32_t Ktable>
+template <class T, class Ch, class R, class W>
+ResamplerCount ResamplerCore<Ksize, Ktable>::run(T *history, Ch nch, const R &read, size_t inFrames, const W &write, size_t outFrames)
+{
+    prepareKernel(history);
+
+    uint32_t historyIndex = fHistoryIndex;
+    ResamplerCount count;
+
+    if (channelLanes(history, nch)) {
+        auto ingestFrame = [history, nch, &historyIndex, &read](size_t i) {
+            ingestLanes(history, nch, historyIndex, read, i);
+        };
+        auto emit = [history, nch, &historyIndex, &write](const T *const rows[], const bool reversed[], uint32_t n, size_t i) {
+            convolveLanes(nch, &history[historyIndex * nch], rows, reversed, n, write, i);
+        };
+        count = loop<T>(ingestFrame, emit, inFrames, outFrames);
+    }
+    else {
+        auto ingestFrame = [history, nch, &historyIndex, &read](size_t i) {
+            ingest(history, nch, historyIndex, read, i);
+        };
+        auto window = [history, &historyIndex](uint32_t c) -> const T * {
+            return &history[c * historySize + historyIndex];
+        };
+        auto emit = [nch, &window, &write](const T *const rows[], const bool reversed[], uint32_t n, size_t i) {
+            convolveRows(nch, window, rows, reversed, n, write, i);
+        };
+        count = loop<T>(ingestFrame, emit, inFrames, outFrames);
     }
 
-    fracPos = fFracPos;
     fHistoryIndex = historyIndex;
+    return count;
+}
+
+template <uint32_t Ksize, uint32_t Ktable>
+template <class T, class Ch, class W>
+ResamplerCount ResamplerCore<Ksize, Ktable>::runDirect(T *history, Ch nch, const T *const in[], size_t inFrames, const W &write, size_t outFrames)
+{
+    prepareKernel(history);
+
+    // the history becomes [window | first frames of the block], so that
+    // the windows which start before the block are contiguous too
+    uint64_t timer = fCounters.start();
+    const uint32_t index = fHistoryIndex;
+    const size_t bridge = std::min(inFrames, (size_t)Ksize);
+    for (uint32_t c = 0; c < nch; ++c) {
+        T *hist = &history[c * historySize];
+        if (index != 0)
+            std::memmove(hist, hist + index, Ksize * sizeof(T));
+        std::memcpy(hist + Ksize, in[c], bridge * sizeof(T));
+    }
+    fCounters.ingest(timer);
+
+    size_t position = 0;
+
+    auto ingestFrame = [&position](size_t) {
+        ++position;
+    };
+    auto window = [history, in, &position](uint32_t c) -> const T * {
+        if (position <= Ksize)
+            return &history[c * historySize + position];
+        return &in[c][position - Ksize];
+    };
+    auto emit = [nch, &window, &write](const T *const rows[], const bool reversed[], uint32_t n, size_t i) {
+        convolveRows(nch, window, rows, reversed, n, write, i);
+    };
+
+    ResamplerCount count = loop<T>(ingestFrame, emit, inFrames, outFrames);
+
+    // keep the last window, in the layout of the history at index zero
+    timer = fCounters.start();
+    for (uint32_t c = 0; c < nch; ++c) {
+        T *hist = &history[c * historySize];
+        std::memmove(hist, window(c), Ksize * sizeof(T));
+        std::memcpy(hist + Ksize, hist, Ksize * sizeof(T));
+    }
+    fHistoryIndex = 0;
+    fCounters.ingest(timer);
+
+    return count;
 }
 
-template <uint32_t Nch, uint32_t Ksize, uint32_t Kover>
-auto Resampler<Nch, Ksize, Kover>::makeKernel() -> Kmat
+template <uint32_t Ksize, uint32_t Ktable>
+template <class T, class Ch, class W>
+ResamplerCount ResamplerCore<Ksize, Ktable>::runDirectLanes(T *history, Ch nch, const T *in, size_t inFrames, const W &write, size_t outFrames)
 {
-    auto sinc = [](double x) -> double
-    {
-        if (x == 0)
-            return 1;
-        return std::sin(M_PI * x) / (M_PI * x);
+    prepareKernel(history);
+
+    // as `runDirect`, with frames of `nch` samples
+    uint64_t timer = fCounters.start();
+    const size_t window = (size_t)Ksize * nch;
+    const uint32_t index = fHistoryIndex;
+    if (index != 0)
+        std::memmove(history, history + index * nch, window * sizeof(T));
+    std::memcpy(history + window, in, std::min(inFrames, (size_t)Ksize) * nch * sizeof(T));
+    fCounters.ingest(timer);
+
+    size_t position = 0;
+
+    auto ingestFrame = [&position](size_t) {
+        ++position;
+    };
+    auto frames = [history, in, nch, &position]() -> const T * {
+        if (position <= Ksize)
+            return &history[position * nch];
+        return &in[(position - Ksize) * nch];
     };
+    auto emit = [nch, &frames, &write](const T *const rows[], const bool reversed[], uint32_t n, size_t i) {
+        convolveLanes(nch, frames(), rows, reversed, n, write, i);
+    };
+
+    ResamplerCount count = loop<T>(ingestFrame, emit, inFrames, outFrames);
 
-    Kmat mat;
-    for (uint32_t o = 0; o < Kover; ++o) {
-        Krow &row = mat[o];
-        double offset = o / (double)Kover;
-        double sum = 0;
-        for (uint32_t i = 0; i < Ksize; ++i) {
-            double a = 0.5 * (Ksize - 1);
-            double x = i - a - offset;
-            double k = 0;
-            double window = 0;
-
-            #if 0
-            // lanczos window
-            if (x > -a && x < a)
-                window = sinc(x / a);
-            #else
-            // kaiser window
-            {
-                const double alpha = 2.5;
-                const double beta = M_PI * alpha;
-                double t = x / (0.5 * Ksize);
-                t = 1.0 - t * t;
-                if (t > 0)
-                    window = i0(beta * std::sqrt(t)) / i0(beta);
+    timer = fCounters.start();
+    std::memmove(history, frames(), window * sizeof(T));
+    std::memcpy(history + window, history, window * sizeof(T));
+    fHistoryIndex = 0;
+    fCounters.ingest(timer);
+
+    return count;
+}
+
+template <uint32_t Ksize, uint32_t Ktable>
+template <class T, class I, class E>
+ResamplerCount ResamplerCore<Ksize, Ktable>::loop(const I &ingest, const E &emit, size_t inFrames, size_t outFrames)
+{
+    const uint64_t one = fPhaseOne;
+    const uint64_t incr = fPhaseIncr;
+    uint64_t phase = fPhase;
+    std::array<T, Ksize> buffers[batchSize];
+
+    size_t consumed = 0;
+    size_t produced = 0;
+    uint64_t timer = fCounters.start();
+
+    while (produced < outFrames) {
+        while (phase >= one && consumed < inFrames) {
+            ingest(consumed);
+            phase -= one;
+            ++consumed;
+        }
+        fCounters.ingest(timer);
+
+        if (phase >= one)
+            break;
+
+        // number of outputs before the next input frame
+        uint64_t count = (one - phase + incr - 1) / incr;
+        count = std::min(count, (uint64_t)batchSize);
+        count = std::min(count, (uint64_t)(outFrames - produced));
+
+        const T *rows[batchSize];
+        bool reversed[batchSize];
+        for (uint32_t j = 0; j < batchSize; ++j) {
+            if (j < count)
+                rows[j] = kernelRow(phase + j * incr, buffers[j].data(), reversed[j]);
+            else {
+                rows[j] = rows[count - 1];
+                reversed[j] = reversed[count - 1];
             }
-            #endif
+        }
+        emit(rows, reversed, (uint32_t)count, produced);
+        fCounters.convolve(timer);
+
+        produced += count;
+        phase += count * incr;
+    }
+
+    fPhase = phase;
+    fCounters.count(consumed, produced);
+
+    return ResamplerCount{consumed, produced};
+}
+
+template <uint32_t Ksize, uint32_t Ktable>
+inline const float *ResamplerCore<Ksize, Ktable>::kernelRow(uint64_t phase, float *buffer, bool &reversed) const
+{
+    reversed = false;
+    if (fRational)
+        return &fBank[phase * Ksize];
+
+    uint64_t pos = phase * Kover;
+    if (fCompact)
+        return compactRow(pos, buffer, reversed);
+
+    uint32_t o = (uint32_t)(pos >> 32);
+
+    if (!fInterpolated)
+        return &fKernel[(size_t)o * Ksize];
+
+    float mu = (uint32_t)pos * (1.0f / phaseOne);
+    ResamplerSIMD::functions().interpolate(buffer, &fKernel[(size_t)o * Ksize], &fKernel[(size_t)(o + 1) * Ksize], mu, Ksize);
+    return buffer;
+}
+
+template <uint32_t Ksize, uint32_t Ktable>
+const float *ResamplerCore<Ksize, Ktable>::compactRow(uint64_t pos, float *buffer, bool &reversed) const
+{
+    uint32_t o = (uint32_t)(pos >> 32);
+
+    if (!fInterpolated)
+        return storedRow(o, buffer, reversed);
+
+    std::array<float, Ksize> next;
+    bool nextReversed;
+    const float *a = storedRow(o, buffer, reversed);
+    const float *b = storedRow(o + 1, next.data(), nextReversed);
+
+    // the mirror is linear: two reversed rows interpolate as their sources,
+    // and only the rows around one half need a copy in the same direction
+    std::array<float, Ksize> mirrored;
+    if (nextReversed != reversed) {
+        mirrored[0] = 0;
+        for (uint32_t i = 1; i < Ksize; ++i)
+            mirrored[i] = b[Ksize - i];
+        b = mirrored.data();
+    }
+
+    float mu = (uint32_t)pos * (1.0f / phaseOne);
+    ResamplerSIMD::functions().interpolate(buffer, a, b, mu, Ksize);
+    return buffer;
+}
+
+template <uint32_t Ksize, uint32_t Ktable>
+const float *ResamplerCore<Ksize, Ktable>::storedRow(uint32_t o, float *buffer, bool &reversed) const
+{
+    // the row of the offset 1 - x, reversed, is the one of x shifted by a
+    // coefficient, and its first one is past the end of the window
+    reversed = fMirrored && o > Kover / 2;
+    const size_t source = reversed ? (Kover - o) : o;
+
+    if (!fKernel16)
+        return &fKernel[source * Ksize];
+
+    const ResamplerSIMD::Functions &simd = ResamplerSIMD::functions();
+    ResamplerSIMD::WidenFunction *widen = (fFormat == ResamplerFormat::BFloat16) ? simd.widenBFloat16 : simd.widenFloat16;
+    widen(buffer, &fKernel16[source * Ksize], Ksize);
+    return buffer;
+}
+
+template <uint32_t Ksize, uint32_t Ktable>
+inline const int16_t *ResamplerCore<Ksize, Ktable>::kernelRow(uint64_t phase, int16_t *buffer, bool &reversed) const
+{
+    reversed = false;
+    if (fRational)
+        return &fBankQ15[phase * Ksize];
+
+    uint64_t pos = phase * Kover;
+    uint32_t o = (uint32_t)(pos >> 32);
+
+    if (!fInterpolated)
+        return &fKernelQ15[(size_t)o * Ksize];
+
+    // interpolate with the fraction in Q15, rounded
+    const int16_t *a = &fKernelQ15[(size_t)o * Ksize];
+    const int16_t *b = &fKernelQ15[(size_t)(o + 1) * Ksize];
+    int32_t mu = (int32_t)((uint32_t)pos >> 17);
+    for (uint32_t i = 0; i < Ksize; ++i)
+        buffer[i] = (int16_t)(a[i] + (((b[i] - a[i]) * mu + (1 << 14)) >> 15));
+    return buffer;
+}
+
+template <uint32_t Ksize, uint32_t Ktable>
+template <class T, class Ch, class R>
+inline void ResamplerCore<Ksize, Ktable>::ingest(T *history, Ch nch, uint32_t &historyIndex, const R &read, size_t i)
+{
+    uint32_t index = historyIndex;
+
+    for (uint32_t c = 0; c < nch; ++c) {
+        T *hist = &history[c * historySize];
+        T x = read(i, c);
+        hist[index] = x;
+        hist[index + Ksize] = x;
+    }
+
+    historyIndex = (index + 1) % Ksize;
+}
+
+template <uint32_t Ksize, uint32_t Ktable>
+template <class T, class Ch, class R>
+inline void ResamplerCore<Ksize, Ktable>::ingestLanes(T *history, Ch nch, uint32_t &historyIndex, const R &read, size_t i)
+{
+    uint32_t index = historyIndex;
+    T *frame = &history[index * nch];
+    T *duplicate = &history[(index + Ksize) * nch];
+
+    for (uint32_t c = 0; c < nch; ++c) {
+        T x = read(i, c);
+        frame[c] = x;
+        duplicate[c] = x;
+    }
+
+    historyIndex = (index + 1) % Ksize;
+}
+
+template <uint32_t Ksize, uint32_t Ktable>
+template <class T, class Ch, class V, class W>
+inline void ResamplerCore<Ksize, Ktable>::convolveRows(Ch nch, const V &window, const T *const rows[], const bool reversed[], uint32_t count, const W &write, size_t i)
+{
+    if (count < 2)
+        convolve(nch, window, rows[0], reversed[0], write, i);
+    else
+        convolveBatch(nch, window, rows, reversed, count, write, i);
+}
 
-            k = window * sinc(x);
-            row[i] = k;
-            sum += k;
+template <uint32_t Ksize, uint32_t Ktable>
+template <class Ch, class V, class W>
+inline void ResamplerCore<Ksize, Ktable>::convolve(Ch nch, const V &window, const float *row, bool reversed, const W &write, size_t i)
+{
+    const ResamplerSIMD::Functions &simd = ResamplerSIMD::functions();
+
+    if (reversed) {
+        for (uint32_t c = 0; c < nch; ++c)
+            write(i, c, simd.dotReversed(row + 1, window(c) + 1, Ksize - 1));
+        return;
+    }
+
+    for (uint32_t c = 0; c < nch; ++c)
+        write(i, c, simd.dot(row, window(c), Ksize));
+}
+
+template <uint32_t Ksize, uint32_t Ktable>
+template <class Ch, class V, class W>
+inline void ResamplerCore<Ksize, Ktable>::convolve(Ch nch, const V &window, const int16_t *row, bool, const W &write, size_t i)
+{
+    // the fixed-point rows are never reversed
+    ResamplerSIMD::DotInt16Function *dot = ResamplerSIMD::functions().dotInt16;
+
+    for (uint32_t c = 0; c < nch; ++c)
+        write(i, c, roundQ15(dot(row, window(c), Ksize)));
+}
+
+template <uint32_t Ksize, uint32_t Ktable>
+template <class Ch, class V, class W>
+inline void ResamplerCore<Ksize, Ktable>::convolveBatch(Ch nch, const V &window, const float *const rows[], const bool reversed[], uint32_t count, const W &write, size_t i)
+{
+    static_assert(batchSize == 4, "The batch must match the SIMD primitive.");
+    const ResamplerSIMD::Functions &simd = ResamplerSIMD::functions();
+
+    bool mixed = false;
+    for (uint32_t j = 0; j < count; ++j)
+        mixed = mixed || reversed[j];
+
+    for (uint32_t c = 0; c < nch; ++c) {
+        float r[batchSize];
+        const float *w = window(c);
+        if (!mixed)
+            simd.dot4(r, rows, w, Ksize);
+        else {
+            for (uint32_t j = 0; j < count; ++j)
+                r[j] = reversed[j] ? simd.dotReversed(rows[j] + 1, w + 1, Ksize - 1) : simd.dot(rows[j], w, Ksize);
         }
-        if (0) {
-            for (uint32_t i = 0; i < Ksize; ++i)
-                row[i] /= sum; // normalize for unity gain
+        for (uint32_t j = 0; j < count; ++j)
+            write(i + j, c, r[j]);
+    }
+}
+
+template <uint32_t Ksize, uint32_t Ktable>
+template <class Ch, class V, class W>
+inline void ResamplerCore<Ksize, Ktable>::convolveBatch(Ch nch, const V &window, const int16_t *const rows[], const bool reversed[], uint32_t count, const W &write, size_t i)
+{
+    // the integer dot products are short enough to not need batching
+    for (uint32_t j = 0; j < count; ++j)
+        convolve(nch, window, rows[j], reversed[j], write, i + j);
+}
+
+template <uint32_t Ksize, uint32_t Ktable>
+template <class Ch, class W>
+inline void ResamplerCore<Ksize, Ktable>::convolveLanes(Ch nch, const float *frames, const float *const rows[], const bool reversed[], uint32_t count, const W &write, size_t i)
+{
+    ResamplerSIMD::DotLanesFunction *dotLanes = ResamplerSIMD::functions().dotLanes;
+
+    // channels by groups which fit in registers
+    const uint32_t group = 16;
+    float r[group];
+
+    // the lanes read the row by coefficient, so a reversed row is copied
+    // once for all the channels
+    std::array<float, Ksize> mirrored;
+
+    for (uint32_t j = 0; j < count; ++j) {
+        const float *row = rows[j];
+        if (reversed[j]) {
+            mirrored[0] = 0;
+            for (uint32_t k = 1; k < Ksize; ++k)
+                mirrored[k] = row[Ksize - k];
+            row = mirrored.data();
+        }
+        for (uint32_t c0 = 0; c0 < nch; c0 += group) {
+            uint32_t lanes = (nch - c0 < group) ? (nch - c0) : group;
+            dotLanes(r, row, frames + c0, Ksize, lanes, nch);
+            for (uint32_t c = 0; c < lanes; ++c)
+                write(i + j, c0 + c, r[c]);
+        }
+    }
+}
+
+template <uint32_t Ksize, uint32_t Ktable>
+template <class Ch, class W>
+inline void ResamplerCore<Ksize, Ktable>::convolveLanes(Ch nch, const int16_t *frames, const int16_t *const rows[], const bool *, uint32_t count, const W &write, size_t i)
+{
+    ResamplerSIMD::DotLanesInt16Function *dotLanes = ResamplerSIMD::functions().dotLanesInt16;
+
+    const uint32_t group = 16;
+    int32_t r[group];
+
+    for (uint32_t j = 0; j < count; ++j) {
+        for (uint32_t c0 = 0; c0 < nch; c0 += group) {
+            uint32_t lanes = (nch - c0 < group) ? (nch - c0) : group;
+            dotLanes(r, rows[j], frames + c0, Ksize, lanes, nch);
+            for (uint32_t c = 0; c < lanes; ++c)
+                write(i + j, c0 + c, roundQ15(r[c]));
         }
     }
-    return mat;
+}
+
+template <uint32_t Ksize, uint32_t Ktable>
+inline int16_t ResamplerCore<Ksize, Ktable>::roundQ15(int32_t acc)
+{
+    int64_t y = ((int64_t)acc + (1 << 14)) >> 15;
+    y = (y < -32768) ? -32768 : (y > 32767) ? 32767 : y;
+    return (int16_t)y;
+}
+
+template <uint32_t Nch, uint32_t Ksize, uint32_t Ktable>
+void Resampler<Nch, Ksize, Ktable>::clear()
+{
+    fCore.clear();
+    fHistory.fill(0);
+    fHistoryInt16.fill(0);
+}
+
+template <uint32_t Nch, uint32_t Ksize, uint32_t Ktable>
+template <class G, class P>
+void Resampler<Nch, Ksize, Ktable>::resample(const G &getNext, const P &putNext, uint32_t putCount)
+{
+    std::array<float, Nch> next;
+    std::array<std::array<float, Nch>, Core::batchSize> out;
+
+    ResamplerCounters &counters = fCore.counters();
+
+    auto read = [&getNext, &next, &counters](size_t, uint32_t c) -> float {
+        if (c == 0) {
+            uint64_t timer = counters.start();
+            getNext(next.data());
+            counters.callback(timer);
+        }
+        return next[c];
+    };
+    // the frames of a batch are complete in order, at their last channel
+    auto write = [&putNext, &out, &counters](size_t i, uint32_t c, float x) {
+        std::array<float, Nch> &frame = out[i % Core::batchSize];
+        frame[c] = x;
+        if (c == Nch - 1) {
+            uint64_t timer = counters.start();
+            putNext(frame.data());
+            counters.callback(timer);
+        }
+    };
+
+    fCore.run(fHistory.data(), Channels(), read, SIZE_MAX, write, putCount);
 }
@@ -0,0 +1,62 @@
+#include "resampler_drift.h"
+#include <algorithm>
+#include <cmath>
+
+ResamplerDriftController::ResamplerDriftController()
+{
+    setup(1, 48000, 0);
+}
+
+void ResamplerDriftController::setup(double ratio, double inputRate, double targetFill, double bandwidth)
+{
+    fNominalRatio = ratio;
+    fInputRate = inputRate;
+    fTargetFill = targetFill;
+
+    // the error follows: e'' = -inputRate * (Kp e' + Ki e)
+    // choose a damping of 1/sqrt(2), and a natural frequency w
+    const double zeta = M_SQRT1_2;
+    const double w = 2 * M_PI * bandwidth;
+    fKp = 2 * zeta * w / inputRate;
+    fKi = w * w / inputRate;
+    fSmoothing = 8 * w;
+
+    reset();
+}
+
+void ResamplerDriftController::reset()
+{
+    fError = 0;
+    fIntegral = 0;
+    fCorrection = 0;
+    fFirst = true;
+}
+
+double ResamplerDriftController::update(double fill, size_t outFrames)
+{
+    const double dt = outFrames / (fInputRate * fNominalRatio);
+    const double error = fill - fTargetFill;
+
+    if (fFirst) {
+        fError = error;
+        fFirst = false;
+    }
+    else
+        fError += (error - fError) * std::min(1.0, fSmoothing * dt);
+
+    // integrate only when the output is not saturated (anti-windup)
+    double correction = fKp * fError + fIntegral;
+    if (std::fabs(correction) < fMaxDeviation)
+        fIntegral += fKi * fError * dt;
+
+    correction = fKp * fError + fIntegral;
+    fCorrection = std::max(-fMaxDeviation, std::min(fMaxDeviation, correction));
+
+    return ratio();
+}
+
+double ResamplerDriftController::ratio() const
+{
+    // a positive correction consumes the input faster
+    return fNominalRatio / (1 + fCorrection);
+}
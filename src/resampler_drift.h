@@ -0,0 +1,94 @@
+#pragma once
+#include <cstddef>
+
+/**
+   Controller of the ratio of an asynchronous resampler
+
+   The input arrives into a FIFO at the rate of one clock, and the resampler
+   drains it at the rate of another. The controller observes the fill level
+   of the FIFO, and steers the ratio to keep the level at a target, which
+   compensates the drift between the two clocks.
+
+   It is a second-order loop: a proportional-integral control of the fill
+   error, whose integral converges to the relative drift of the clocks.
+   The error is smoothed before use, to reject the jitter of the level
+   caused by the block sizes of the producer and of the consumer.
+ */
+class ResamplerDriftController {
+public:
+    ResamplerDriftController();
+
+    /**
+       Set the parameters of the control, and reset its state.
+
+       `ratio` nominal ratio of rate conversion: ratio = Fs_out/Fs_in
+       `inputRate` nominal input rate, in frames per second
+       `targetFill` fill level to maintain, in input frames
+       `bandwidth` natural frequency of the loop, in Hz
+     */
+    void setup(double ratio, double inputRate, double targetFill, double bandwidth = 0.05);
+
+    /**
+       Set the maximum relative deviation of the ratio from the nominal.
+     */
+    void setMaxDeviation(double deviation) { fMaxDeviation = deviation; }
+
+    /**
+       Reset the state of the control, keeping the parameters.
+     */
+    void reset();
+
+    /**
+       Observe the fill level of the FIFO, in input frames, after `outFrames`
+       output frames were produced since the last update.
+
+       If the producer writes large blocks, the level is best extrapolated
+       from the time of its last write; otherwise the block sawtooth, as
+       sampled by the consumer, beats slowly with the drift.
+
+       Returns the ratio to use next.
+     */
+    double update(double fill, size_t outFrames);
+
+    /**
+       Get the ratio to use next.
+     */
+    double ratio() const;
+
+    /**
+       Get the estimated drift of the input clock relative to the output
+       clock, for example 1e-4 if the input runs 100 ppm faster.
+     */
+    double drift() const { return fIntegral; }
+
+    /**
+       Get the smoothed fill level.
+     */
+    double fill() const { return fTargetFill + fError; }
+
+private:
+    double fNominalRatio = 1;
+    double fInputRate = 48000;
+    double fTargetFill = 0;
+    double fMaxDeviation = 0.005;
+
+    /**
+       Gains of the control, and angular frequency of the error smoothing
+     */
+    double fKp = 0;
+    double fKi = 0;
+    double fSmoothing = 0;
+
+    /**
+       Smoothed error of the fill level, and integral term
+     */
+    double fError = 0;
+    double fIntegral = 0;
+
+    /**
+       Relative correction of the input consumption
+     */
+    double fCorrection = 0;
+
+    bool fFirst = true;
+};
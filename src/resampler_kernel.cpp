@@ -0,0 +1,378 @@
+#include "resampler_kernel.h"
+#include "resampler_math.h"
+#include <algorithm>
+#include <complex>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <vector>
+#include <cmath>
+#include <cstring>
+
+bool operator<(const ResamplerKernelSpec &a, const ResamplerKernelSpec &b)
+{
+    return std::make_tuple(a.size, a.rows, a.window, a.alpha, a.cutoff, a.response) <
+        std::make_tuple(b.size, b.rows, b.window, b.alpha, b.cutoff, b.response);
+}
+
+namespace ResamplerKernel {
+
+ResamplerKernelSpec normalize(const ResamplerKernelSpec &spec)
+{
+    ResamplerKernelSpec normalized = spec;
+    if (spec.window != ResamplerWindow::Kaiser)
+        normalized.alpha = 0;
+    return normalized;
+}
+
+/**
+   Value of the windowed sinc at `x` frames from its center
+ */
+static double prototype(const ResamplerKernelSpec &spec, double x)
+{
+    using ResamplerMath::i0;
+
+    auto sinc = [](double x) -> double
+    {
+        if (x == 0)
+            return 1;
+        return std::sin(M_PI * x) / (M_PI * x);
+    };
+
+    const uint32_t size = spec.size;
+    const double cutoff = spec.cutoff;
+    double window = 0;
+
+    switch (spec.window) {
+    case ResamplerWindow::Lanczos: {
+        double a = 0.5 * (size - 1);
+        if (x > -a && x < a)
+            window = sinc(x / a);
+        break;
+    }
+    case ResamplerWindow::Kaiser: {
+        const double beta = M_PI * spec.alpha;
+        double t = x / (0.5 * size);
+        t = 1.0 - t * t;
+        if (t > 0)
+            window = i0(beta * std::sqrt(t)) / i0(beta);
+        break;
+    }
+    }
+
+    return window * ((cutoff < 1) ? (cutoff * sinc(cutoff * x)) : sinc(x));
+}
+
+void makeRow(float *row, const ResamplerKernelSpec &spec, double offset)
+{
+    const uint32_t size = spec.size;
+
+    double sum = 0;
+    for (uint32_t i = 0; i < size; ++i) {
+        double a = 0.5 * (size - 1);
+        double k = prototype(spec, i - a - offset);
+        row[i] = k;
+        sum += k;
+    }
+    if (0) {
+        for (uint32_t i = 0; i < size; ++i)
+            row[i] /= sum; // normalize for unity gain
+    }
+}
+
+/**
+   In-place FFT of a power of two size, or the inverse, unscaled
+ */
+static void fft(std::complex<double> *x, size_t n, bool inverse)
+{
+    for (size_t i = 1, j = 0; i < n; ++i) {
+        size_t bit = n >> 1;
+        for (; j & bit; bit >>= 1)
+            j ^= bit;
+        j |= bit;
+        if (i < j)
+            std::swap(x[i], x[j]);
+    }
+
+    std::vector<std::complex<double>> twiddles(n / 2);
+    for (size_t k = 0; k < n / 2; ++k)
+        twiddles[k] = std::polar(1.0, (inverse ? 2 : -2) * M_PI * k / n);
+
+    for (size_t len = 2; len <= n; len <<= 1) {
+        const size_t half = len / 2;
+        const size_t step = n / len;
+        for (size_t i = 0; i < n; i += len) {
+            for (size_t k = 0; k < half; ++k) {
+                const std::complex<double> w = twiddles[k * step];
+                const std::complex<double> u = x[i + k];
+                const std::complex<double> b = x[i + k + half];
+                // the product without the checks of infinities
+                const std::complex<double> v(
+                    b.real() * w.real() - b.imag() * w.imag(),
+                    b.real() * w.imag() + b.imag() * w.real());
+                x[i + k] = u + v;
+                x[i + k + half] = u - v;
+            }
+        }
+    }
+}
+
+/**
+   Oversampling of the minimum-phase design, whose kernel is interpolated
+   at the offsets of the table
+ */
+static const uint32_t minimumPhaseOver = 128;
+
+/**
+   Compute the table of a minimum-phase design.
+
+   The windowed sinc, oversampled by `minimumPhaseOver`, is made minimum
+   phase by folding its cepstrum into a causal sequence. The row `o` reads
+   the new kernel from the offset `o / spec.rows`, by steps of one frame,
+   and its last column is the start of the kernel.
+ */
+static void makeMinimumPhase(float *mat, const ResamplerKernelSpec &spec)
+{
+    const uint32_t size = spec.size;
+    const uint32_t rows = spec.rows;
+    const uint32_t over = minimumPhaseOver;
+    const long length = (long)size * over + 1;
+
+    // enough padding for the aliasing of the cepstrum to be negligible
+    size_t n = 1;
+    while (n < 4 * (size_t)length)
+        n <<= 1;
+
+    std::vector<std::complex<double>> x(n);
+    for (long i = 0; i < length; ++i)
+        x[i] = prototype(spec, (double)i / over - 0.5 * size);
+
+    // log-magnitude, with a floor under any stopband for the zeros
+    fft(x.data(), n, false);
+    double peak = 0;
+    for (const std::complex<double> &v : x)
+        peak = std::max(peak, std::abs(v));
+    for (std::complex<double> &v : x)
+        v = std::log(std::max(std::abs(v), 1e-9 * peak));
+
+    fft(x.data(), n, true);
+    for (size_t i = 1; i < n / 2; ++i)
+        x[i] *= 2.0;
+    for (size_t i = n / 2 + 1; i < n; ++i)
+        x[i] = 0;
+
+    fft(x.data(), n, false);
+    for (std::complex<double> &v : x)
+        v = std::exp(v / (double)n);
+    fft(x.data(), n, true);
+
+    // kernel at `t` frames from its start, by cubic interpolation
+    auto kernel = [&x, n, length](double t) -> double {
+        auto at = [&x, n, length](long i) -> double {
+            return (i >= 0 && i < length) ? (x[i].real() / n) : 0;
+        };
+        double p = t * over;
+        long i = (long)std::floor(p);
+        double f = p - i;
+        double y0 = at(i - 1), y1 = at(i), y2 = at(i + 1), y3 = at(i + 2);
+        return -f * (f - 1) * (f - 2) / 6 * y0 + (f + 1) * (f - 1) * (f - 2) / 2 * y1 -
+            (f + 1) * f * (f - 2) / 2 * y2 + (f + 1) * f * (f - 1) / 6 * y3;
+    };
+
+    for (uint32_t o = 0; o < rows + 1; ++o) {
+        for (uint32_t i = 0; i < size; ++i)
+            mat[o * size + i] = kernel((size - 1 - i) + o / (double)rows);
+    }
+}
+
+/**
+   Get the entry of `key` in a cache of tables, built by `build` if missing.
+
+   The build runs without the lock, so that the lookups of other tables do
+   not wait for it. When two threads build the same table, the first one to
+   finish publishes it and the other discards its own.
+ */
+template <class Key, class T, class Build>
+static const T *cached(std::mutex &mutex, std::map<Key, std::unique_ptr<T[]>> &tables, const Key &key, Build build)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = tables.find(key);
+        if (it != tables.end())
+            return it->second.get();
+    }
+
+    std::unique_ptr<T[]> data = build();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    std::unique_ptr<T[]> &entry = tables[key];
+    if (!entry)
+        entry = std::move(data);
+    return entry.get();
+}
+
+/**
+   Get the number of rows of a table, all of them unless folded with a
+   linear phase. (see `table`)
+ */
+static uint32_t tableRows(const ResamplerKernelSpec &spec, bool folded)
+{
+    if (folded && spec.response == ResamplerResponse::LinearPhase)
+        return spec.rows / 2 + 1;
+    return spec.rows + 1;
+}
+
+/**
+   Compute a table of kernels. (see `table`)
+ */
+static std::unique_ptr<float[]> makeTable(const ResamplerKernelSpec &spec, bool folded)
+{
+    const uint32_t size = spec.size;
+    const long rows = spec.rows;
+
+    const long stored = tableRows(spec, folded);
+    std::unique_ptr<float[]> data(new float[stored * size]);
+    float *mat = data.get();
+
+    if (spec.response == ResamplerResponse::MinimumPhase) {
+        makeMinimumPhase(mat, spec);
+        return data;
+    }
+
+    #pragma omp parallel for
+    for (long o = 0; o < stored; ++o)
+        makeRow(&mat[o * size], spec, o / (double)rows);
+    return data;
+}
+
+const float *table(const ResamplerKernelSpec &spec, bool folded)
+{
+    static std::mutex mutex;
+    static std::map<std::pair<ResamplerKernelSpec, bool>, std::unique_ptr<float[]>> tables;
+
+    return cached(mutex, tables, std::make_pair(normalize(spec), folded), [&spec, folded]() {
+        return makeTable(spec, folded);
+    });
+}
+
+const int16_t *tableQ15(const ResamplerKernelSpec &spec)
+{
+    static std::mutex mutex;
+    static std::map<ResamplerKernelSpec, std::unique_ptr<int16_t[]>> tables;
+
+    return cached(mutex, tables, normalize(spec), [&spec]() -> std::unique_ptr<int16_t[]> {
+        const float *source = table(spec);
+        const size_t count = (size_t)(spec.rows + 1) * spec.size;
+
+        std::unique_ptr<int16_t[]> data(new int16_t[count]);
+        int16_t *mat = data.get();
+
+        for (size_t i = 0; i < count; ++i) {
+            long q = std::lround(source[i] * 32768.0);
+            mat[i] = (int16_t)std::max(-32768L, std::min(32767L, q));
+        }
+        return data;
+    });
+}
+
+/**
+   Round a float to the nearest half, ties to even
+ */
+static uint16_t toFloat16(float x)
+{
+    uint32_t bits;
+    std::memcpy(&bits, &x, 4);
+
+    const uint32_t sign = (bits >> 16) & 0x8000;
+    const uint32_t magnitude = bits & 0x7fffffff;
+
+    if (magnitude >= 0x7f800000) // infinity or NaN
+        return (uint16_t)(sign | 0x7c00 | ((magnitude > 0x7f800000) ? 0x200 : 0));
+    if (magnitude >= 0x477ff000) // rounds to more than the largest half
+        return (uint16_t)(sign | 0x7c00);
+
+    if (magnitude < 0x38800000) {
+        // subnormal half: 2^-24 units, which the float addition rounds
+        float f;
+        uint32_t m = magnitude;
+        std::memcpy(&f, &m, 4);
+        return (uint16_t)(sign | (uint32_t)std::nearbyint(f * 16777216.0f));
+    }
+
+    uint32_t h = magnitude - (112u << 23);
+    h += 0xfff + ((h >> 13) & 1);
+    return (uint16_t)(sign | (h >> 13));
+}
+
+/**
+   Round a float to the nearest bfloat16, ties to even
+ */
+static uint16_t toBFloat16(float x)
+{
+    uint32_t bits;
+    std::memcpy(&bits, &x, 4);
+
+    if ((bits & 0x7fffffff) > 0x7f800000) // NaN
+        return (uint16_t)((bits >> 16) | 0x40);
+
+    bits += 0x7fff + ((bits >> 16) & 1);
+    return (uint16_t)(bits >> 16);
+}
+
+const uint16_t *table16(const ResamplerKernelSpec &spec, ResamplerFormat format, bool folded)
+{
+    static std::mutex mutex;
+    static std::map<std::tuple<ResamplerKernelSpec, ResamplerFormat, bool>, std::unique_ptr<uint16_t[]>> tables;
+
+    return cached(mutex, tables, std::make_tuple(normalize(spec), format, folded), [&spec, format, folded]() -> std::unique_ptr<uint16_t[]> {
+        std::unique_ptr<float[]> source = makeTable(spec, folded);
+        const size_t count = (size_t)tableRows(spec, folded) * spec.size;
+
+        std::unique_ptr<uint16_t[]> data(new uint16_t[count]);
+        uint16_t *mat = data.get();
+
+        for (size_t i = 0; i < count; ++i)
+            mat[i] = (format == ResamplerFormat::BFloat16) ? toBFloat16(source[i]) : toFloat16(source[i]);
+        return data;
+    });
+}
+
+double delay(const ResamplerKernelSpec &spec)
+{
+    if (spec.response == ResamplerResponse::LinearPhase)
+        return 0.5 * (spec.size - 1);
+
+    static std::mutex mutex;
+    static std::map<ResamplerKernelSpec, double> delays;
+
+    const ResamplerKernelSpec key = normalize(spec);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = delays.find(key);
+        if (it != delays.end())
+            return it->second;
+    }
+
+    // center of mass of the oversampled kernel (see `makeMinimumPhase`)
+    const float *mat = table(spec);
+    const uint32_t size = spec.size;
+    const uint32_t rows = spec.rows;
+    double moment = 0;
+    double sum = 0;
+    for (uint32_t o = 0; o < rows; ++o) {
+        for (uint32_t i = 0; i < size; ++i) {
+            double h = mat[o * size + i];
+            moment += h * ((size - 1 - i) + o / (double)rows);
+            sum += h;
+        }
+    }
+
+    double d = (sum != 0) ? (moment / sum) : 0;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    delays[key] = d;
+    return d;
+}
+
+} // namespace ResamplerKernel
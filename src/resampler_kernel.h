@@ -0,0 +1,138 @@
+#pragma once
+#include <cstdint>
+
+/**
+   Window function applied to the sinc kernel
+ */
+enum class ResamplerWindow {
+    Kaiser,
+    Lanczos,
+};
+
+/**
+   Phase response of the kernel
+ */
+enum class ResamplerResponse {
+    /**
+       Symmetric windowed sinc, delayed by half of the convolution size
+     */
+    LinearPhase,
+    /**
+       Same magnitude response, with the energy at the start of the kernel:
+       a delay of a few frames, at the cost of a phase distortion which
+       grows towards the cutoff
+     */
+    MinimumPhase,
+};
+
+/**
+   Format of the coefficients in a kernel table
+ */
+enum class ResamplerFormat {
+    Float32,
+    Float16,  // IEEE half precision, 11 significant bits
+    BFloat16, // upper half of a float, 8 significant bits
+};
+
+/**
+   Design parameters of a table of windowed sinc kernels
+ */
+struct ResamplerKernelSpec {
+    /**
+       Convolution size, number of columns of the table
+     */
+    uint32_t size;
+
+    /**
+       Number of fractional offsets in [0:1), one per row of the table
+     */
+    uint32_t rows;
+
+    /**
+       Window function
+     */
+    ResamplerWindow window;
+
+    /**
+       Parameter of the Kaiser window (beta = pi * alpha), ignored by the
+       other windows (see `ResamplerKernel::normalize`)
+     */
+    double alpha;
+
+    /**
+       Cutoff frequency of the lowpass, relative to input Nyquist (0 < cutoff <= 1)
+       When downsampling, it is set to the output Nyquist to reject aliases.
+     */
+    double cutoff;
+
+    /**
+       Phase response
+     */
+    ResamplerResponse response;
+};
+
+bool operator<(const ResamplerKernelSpec &a, const ResamplerKernelSpec &b);
+
+/**
+   Design and storage of the resampler kernels
+ */
+namespace ResamplerKernel {
+    /**
+       Get the design with the parameters which the window ignores set to
+       0, so that the designs of the same kernels are equal.
+
+       The tables are cached by their normalized design.
+     */
+    ResamplerKernelSpec normalize(const ResamplerKernelSpec &spec);
+
+    /**
+       Compute the kernel row for a fractional offset, into `row` of
+       `spec.size` elements.
+     */
+    void makeRow(float *row, const ResamplerKernelSpec &spec, double offset);
+
+    /**
+       Get the table of kernels for the given design.
+
+       The table has `spec.rows + 1` rows of `spec.size` elements: the row `o`
+       is for the offset `o / spec.rows`, and the extra row is for offset 1.
+       If `folded`, which is for a linear phase, it has only the rows up to
+       `spec.rows / 2`: the others are mirrors of them (see
+       `ResamplerCore::setStorage`).
+
+       Tables are shared by the whole process, built on first use, and never
+       freed. This function is thread-safe.
+     */
+    const float *table(const ResamplerKernelSpec &spec, bool folded = false);
+
+    /**
+       Get the table of kernels for the given design, quantized to Q15.
+
+       It has the layout of `table`, with every coefficient rounded to a
+       multiple of 2^-15 and saturated to [-1:1). It is shared and built on
+       first use like `table`. This function is thread-safe.
+     */
+    const int16_t *tableQ15(const ResamplerKernelSpec &spec);
+
+    /**
+       Get the table of kernels for the given design, in a 16-bit floating
+       point format.
+
+       It has the layout of `table`, with every coefficient rounded to the
+       nearest of the format. It is shared and built on first use like
+       `table`, without keeping the table of floats. This function is
+       thread-safe.
+     */
+    const uint16_t *table16(const ResamplerKernelSpec &spec, ResamplerFormat format, bool folded = false);
+
+    /**
+       Get the group delay of the kernels at low frequencies, in input
+       frames: the output is the filtered input of that many frames before
+       its position.
+
+       It is `(spec.size - 1) / 2` for a linear phase. Otherwise it is
+       measured on the table, which is built if needed. This function is
+       thread-safe.
+     */
+    double delay(const ResamplerKernelSpec &spec);
+};
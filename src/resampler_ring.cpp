@@ -0,0 +1,84 @@
+#include "resampler_ring.h"
+#include <algorithm>
+#include <cstring>
+
+ResamplerRingBuffer::ResamplerRingBuffer(uint32_t channels, size_t capacity)
+    : fChannels(channels)
+{
+    size_t size = 1;
+    while (size < capacity)
+        size <<= 1;
+
+    fMask = size - 1;
+    fData.reset(new float[size * channels]());
+}
+
+size_t ResamplerRingBuffer::writable() const
+{
+    size_t w = fWriteCount.load(std::memory_order_relaxed);
+    size_t r = fReadCount.load(std::memory_order_acquire);
+    return capacity() - (w - r);
+}
+
+size_t ResamplerRingBuffer::write(const float *frames, size_t count)
+{
+    const uint32_t nch = fChannels;
+    size_t w = fWriteCount.load(std::memory_order_relaxed);
+    size_t r = fReadCount.load(std::memory_order_acquire);
+
+    count = std::min(count, capacity() - (w - r));
+
+    size_t index = w & fMask;
+    size_t part = std::min(count, capacity() - index);
+    std::memcpy(&fData[index * nch], frames, part * nch * sizeof(float));
+    std::memcpy(&fData[0], frames + part * nch, (count - part) * nch * sizeof(float));
+
+    fWriteCount.store(w + count, std::memory_order_release);
+    return count;
+}
+
+size_t ResamplerRingBuffer::readable() const
+{
+    size_t w = fWriteCount.load(std::memory_order_acquire);
+    size_t r = fReadCount.load(std::memory_order_relaxed);
+    return w - r;
+}
+
+size_t ResamplerRingBuffer::read(float *frames, size_t count)
+{
+    const uint32_t nch = fChannels;
+    Region region = readRegion();
+
+    count = std::min(count, region.firstFrames + region.secondFrames);
+
+    size_t part = std::min(count, region.firstFrames);
+    std::memcpy(frames, region.first, part * nch * sizeof(float));
+    std::memcpy(frames + part * nch, region.second, (count - part) * nch * sizeof(float));
+
+    consume(count);
+    return count;
+}
+
+ResamplerRingBuffer::Region ResamplerRingBuffer::readRegion() const
+{
+    const uint32_t nch = fChannels;
+    size_t w = fWriteCount.load(std::memory_order_acquire);
+    size_t r = fReadCount.load(std::memory_order_relaxed);
+
+    size_t count = w - r;
+    size_t index = r & fMask;
+    size_t part = std::min(count, capacity() - index);
+
+    Region region;
+    region.first = &fData[index * nch];
+    region.firstFrames = part;
+    region.second = &fData[0];
+    region.secondFrames = count - part;
+    return region;
+}
+
+void ResamplerRingBuffer::consume(size_t count)
+{
+    size_t r = fReadCount.load(std::memory_order_relaxed);
+    fReadCount.store(r + count, std::memory_order_release);
+}
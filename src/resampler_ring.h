@@ -0,0 +1,119 @@
+#pragma once
+#include "resampler.h"
+#include <atomic>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+
+/**
+   Wait-free ring buffer of interleaved frames, for one producer thread and
+   one consumer thread
+
+   Neither side locks or allocates, and every operation completes in a time
+   bounded by the number of frames it copies. It is the input source of a
+   resampler running on a realtime thread, with `resampleFromRing`.
+ */
+class ResamplerRingBuffer {
+public:
+    /**
+       Contiguous frames of the buffer, in up to two parts
+     */
+    struct Region {
+        const float *first;
+        size_t firstFrames;
+        const float *second;
+        size_t secondFrames;
+    };
+
+    /**
+       Create a buffer for at least `capacity` frames of `channels` channels.
+       The capacity is rounded to the next power of two.
+     */
+    ResamplerRingBuffer(uint32_t channels, size_t capacity);
+
+    /**
+       Get the number of channels.
+     */
+    uint32_t channels() const { return fChannels; }
+
+    /**
+       Get the capacity, in frames.
+     */
+    size_t capacity() const { return fMask + 1; }
+
+    //--------------------------------------------------------------------------
+    // Producer side
+
+    /**
+       Get the number of frames which can be written.
+     */
+    size_t writable() const;
+
+    /**
+       Write up to `count` interleaved frames.
+       Returns the number of frames written.
+     */
+    size_t write(const float *frames, size_t count);
+
+    //--------------------------------------------------------------------------
+    // Consumer side
+
+    /**
+       Get the number of frames which can be read.
+     */
+    size_t readable() const;
+
+    /**
+       Read up to `count` interleaved frames.
+       Returns the number of frames read.
+     */
+    size_t read(float *frames, size_t count);
+
+    /**
+       Get the readable frames in place, without consuming them.
+     */
+    Region readRegion() const;
+
+    /**
+       Release `count` frames which were read in place.
+     */
+    void consume(size_t count);
+
+    /**
+       Discard all the readable frames.
+     */
+    void flush() { consume(readable()); }
+
+private:
+    uint32_t fChannels = 0;
+    size_t fMask = 0;
+    std::unique_ptr<float[]> fData;
+
+    /**
+       Counters of frames written and read since the start, each on its own
+       cache line, so that the two threads do not contend on stores.
+     */
+    static constexpr size_t cacheLine = 64;
+
+    char fPad0[cacheLine];
+    std::atomic<size_t> fWriteCount{0};
+    char fPad1[cacheLine - sizeof(std::atomic<size_t>)];
+    std::atomic<size_t> fReadCount{0};
+    char fPad2[cacheLine - sizeof(std::atomic<size_t>)];
+};
+
+/**
+   Compute resampled frames from the readable frames of a ring buffer, on
+   the consumer thread. It stops when the output is full, or when the ring
+   buffer has no more frames; the caller decides how to fill an underrun.
+
+   `resampler` a resampler with the block API `process`, such as `Resampler`,
+   `DynamicResampler` or `AsyncResampler`, of as many channels as `ring`
+   `ring` the input source
+   `out` interleaved output frames
+   `outFrames` number of output frames requested
+ */
+template <class R>
+ResamplerCount resampleFromRing(R &resampler, ResamplerRingBuffer &ring, float *out, size_t outFrames);
+
+#include "resampler_ring.tcc"
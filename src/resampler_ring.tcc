@@ -0,0 +1,22 @@
+#include "resampler_ring.h"
+
+template <class R>
+ResamplerCount resampleFromRing(R &resampler, ResamplerRingBuffer &ring, float *out, size_t outFrames)
+{
+    const uint32_t nch = ring.channels();
+    const ResamplerRingBuffer::Region region = ring.readRegion();
+
+    ResamplerCount count = resampler.process(region.first, region.firstFrames, out, outFrames);
+
+    // the first part is exhausted, continue with the wrapped part
+    if (count.produced < outFrames && region.secondFrames > 0) {
+        ResamplerCount c = resampler.process(
+            region.second, region.secondFrames,
+            out + count.produced * nch, outFrames - count.produced);
+        count.consumed += c.consumed;
+        count.produced += c.produced;
+    }
+
+    ring.consume(count.consumed);
+    return count;
+}
@@ -0,0 +1,1247 @@
+#include "resampler_simd.h"
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#   define RESAMPLER_SIMD_X86 1
+#   include <immintrin.h>
+#elif defined(__ARM_NEON)
+#   define RESAMPLER_SIMD_NEON 1
+#   include <arm_neon.h>
+#endif
+
+namespace ResamplerSIMD {
+
+//------------------------------------------------------------------------------
+// Scalar
+
+static float dotScalar(const float *a, const float *b, uint32_t n)
+{
+    float s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+    uint32_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        s0 += a[i] * b[i];
+        s1 += a[i + 1] * b[i + 1];
+        s2 += a[i + 2] * b[i + 2];
+        s3 += a[i + 3] * b[i + 3];
+    }
+    for (; i < n; ++i)
+        s0 += a[i] * b[i];
+    return (s0 + s1) + (s2 + s3);
+}
+
+static void dot4Scalar(float *r, const float *const a[4], const float *b, uint32_t n)
+{
+    for (uint32_t j = 0; j < 4; ++j)
+        r[j] = dotScalar(a[j], b, n);
+}
+
+static void dotLanesScalar(float *r, const float *h, const float *x, uint32_t n, uint32_t lanes, uint32_t stride)
+{
+    for (uint32_t c = 0; c < lanes; ++c)
+        r[c] = 0;
+    for (uint32_t k = 0; k < n; ++k) {
+        const float *row = x + (size_t)k * stride;
+        float hk = h[k];
+        for (uint32_t c = 0; c < lanes; ++c)
+            r[c] += hk * row[c];
+    }
+}
+
+static void interpolateScalar(float *r, const float *a, const float *b, float t, uint32_t n)
+{
+    for (uint32_t i = 0; i < n; ++i)
+        r[i] = a[i] + t * (b[i] - a[i]);
+}
+
+static float dotSymmetricScalar(const float *a, const float *b, const float *h, uint32_t n)
+{
+    float s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+    const float *r = b + n - 1;
+    uint32_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        s0 += h[i] * (a[i] + r[-(int32_t)i]);
+        s1 += h[i + 1] * (a[i + 1] + r[-(int32_t)i - 1]);
+        s2 += h[i + 2] * (a[i + 2] + r[-(int32_t)i - 2]);
+        s3 += h[i + 3] * (a[i + 3] + r[-(int32_t)i - 3]);
+    }
+    for (; i < n; ++i)
+        s0 += h[i] * (a[i] + r[-(int32_t)i]);
+    return (s0 + s1) + (s2 + s3);
+}
+
+static float dotReversedScalar(const float *a, const float *b, uint32_t n)
+{
+    float s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+    const float *r = b + n - 1;
+    uint32_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        s0 += a[i] * r[-(int32_t)i];
+        s1 += a[i + 1] * r[-(int32_t)i - 1];
+        s2 += a[i + 2] * r[-(int32_t)i - 2];
+        s3 += a[i + 3] * r[-(int32_t)i - 3];
+    }
+    for (; i < n; ++i)
+        s0 += a[i] * r[-(int32_t)i];
+    return (s0 + s1) + (s2 + s3);
+}
+
+static int32_t dotInt16Scalar(const int16_t *a, const int16_t *b, uint32_t n)
+{
+    uint32_t s0 = 0, s1 = 0;
+    uint32_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        s0 += (uint32_t)(a[i] * b[i]);
+        s1 += (uint32_t)(a[i + 1] * b[i + 1]);
+    }
+    for (; i < n; ++i)
+        s0 += (uint32_t)(a[i] * b[i]);
+    return (int32_t)(s0 + s1);
+}
+
+static void dotLanesInt16Scalar(int32_t *r, const int16_t *h, const int16_t *x, uint32_t n, uint32_t lanes, uint32_t stride)
+{
+    for (uint32_t c = 0; c < lanes; ++c) {
+        uint32_t s = 0;
+        for (uint32_t k = 0; k < n; ++k)
+            s += (uint32_t)(h[k] * x[(size_t)k * stride + c]);
+        r[c] = (int32_t)s;
+    }
+}
+
+static float float16ToFloat(uint16_t h)
+{
+    const uint32_t sign = (uint32_t)(h & 0x8000) << 16;
+    const uint32_t exponent = (h >> 10) & 0x1f;
+    const uint32_t mantissa = h & 0x3ff;
+
+    if (exponent == 0) {
+        // zero or subnormal, in units of 2^-24
+        float x = mantissa * (1.0f / 16777216.0f);
+        return sign ? -x : x;
+    }
+
+    uint32_t bits = sign | (mantissa << 13);
+    if (exponent != 31)
+        bits |= (exponent + 112) << 23;
+    else
+        bits |= mantissa ? 0x7fc00000 : 0x7f800000; // NaN made quiet, like F16C
+    float x;
+    std::memcpy(&x, &bits, 4);
+    return x;
+}
+
+static void widenFloat16Scalar(float *r, const uint16_t *a, uint32_t n)
+{
+    for (uint32_t i = 0; i < n; ++i)
+        r[i] = float16ToFloat(a[i]);
+}
+
+static void widenBFloat16Scalar(float *r, const uint16_t *a, uint32_t n)
+{
+    for (uint32_t i = 0; i < n; ++i) {
+        uint32_t bits = (uint32_t)a[i] << 16;
+        std::memcpy(&r[i], &bits, 4);
+    }
+}
+
+static const Functions sScalar = {
+    Isa::Scalar,
+    &dotScalar,
+    &dot4Scalar,
+    &dotLanesScalar,
+    &interpolateScalar,
+    &dotSymmetricScalar,
+    &dotReversedScalar,
+    &dotInt16Scalar,
+    &dotLanesInt16Scalar,
+    &widenFloat16Scalar,
+    &widenBFloat16Scalar,
+};
+
+//------------------------------------------------------------------------------
+// x86
+
+#if defined(RESAMPLER_SIMD_X86)
+__attribute__((target("sse2")))
+static float hsumSSE2(__m128 v)
+{
+    v = _mm_add_ps(v, _mm_movehl_ps(v, v));
+    v = _mm_add_ss(v, _mm_shuffle_ps(v, v, 1));
+    return _mm_cvtss_f32(v);
+}
+
+/**
+   Compute the horizontal sums of 4 vectors, into the 4 elements of one
+ */
+__attribute__((target("sse2")))
+static __m128 hsum4SSE2(__m128 s0, __m128 s1, __m128 s2, __m128 s3)
+{
+    // each sum is (v0 + v2) + (v1 + v3), as in `hsumSSE2`
+    _MM_TRANSPOSE4_PS(s0, s1, s2, s3);
+    return _mm_add_ps(_mm_add_ps(s0, s2), _mm_add_ps(s1, s3));
+}
+
+__attribute__((target("sse2")))
+static float dotSSE2(const float *a, const float *b, uint32_t n)
+{
+    __m128 s0 = _mm_setzero_ps();
+    __m128 s1 = _mm_setzero_ps();
+    uint32_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        s0 = _mm_add_ps(s0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+        s1 = _mm_add_ps(s1, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+    }
+    for (; i + 4 <= n; i += 4)
+        s0 = _mm_add_ps(s0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+    float s = hsumSSE2(_mm_add_ps(s0, s1));
+    for (; i < n; ++i)
+        s += a[i] * b[i];
+    return s;
+}
+
+__attribute__((target("sse2")))
+static void dot4SSE2(float *r, const float *const a[4], const float *b, uint32_t n)
+{
+    const float *a0 = a[0], *a1 = a[1], *a2 = a[2], *a3 = a[3];
+    // the accumulators of `dotSSE2`, for every row
+    __m128 s00 = _mm_setzero_ps(), s01 = _mm_setzero_ps();
+    __m128 s10 = _mm_setzero_ps(), s11 = _mm_setzero_ps();
+    __m128 s20 = _mm_setzero_ps(), s21 = _mm_setzero_ps();
+    __m128 s30 = _mm_setzero_ps(), s31 = _mm_setzero_ps();
+    uint32_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m128 x0 = _mm_loadu_ps(b + i);
+        __m128 x1 = _mm_loadu_ps(b + i + 4);
+        s00 = _mm_add_ps(s00, _mm_mul_ps(_mm_loadu_ps(a0 + i), x0));
+        s01 = _mm_add_ps(s01, _mm_mul_ps(_mm_loadu_ps(a0 + i + 4), x1));
+        s10 = _mm_add_ps(s10, _mm_mul_ps(_mm_loadu_ps(a1 + i), x0));
+        s11 = _mm_add_ps(s11, _mm_mul_ps(_mm_loadu_ps(a1 + i + 4), x1));
+        s20 = _mm_add_ps(s20, _mm_mul_ps(_mm_loadu_ps(a2 + i), x0));
+        s21 = _mm_add_ps(s21, _mm_mul_ps(_mm_loadu_ps(a2 + i + 4), x1));
+        s30 = _mm_add_ps(s30, _mm_mul_ps(_mm_loadu_ps(a3 + i), x0));
+        s31 = _mm_add_ps(s31, _mm_mul_ps(_mm_loadu_ps(a3 + i + 4), x1));
+    }
+    for (; i + 4 <= n; i += 4) {
+        __m128 x = _mm_loadu_ps(b + i);
+        s00 = _mm_add_ps(s00, _mm_mul_ps(_mm_loadu_ps(a0 + i), x));
+        s10 = _mm_add_ps(s10, _mm_mul_ps(_mm_loadu_ps(a1 + i), x));
+        s20 = _mm_add_ps(s20, _mm_mul_ps(_mm_loadu_ps(a2 + i), x));
+        s30 = _mm_add_ps(s30, _mm_mul_ps(_mm_loadu_ps(a3 + i), x));
+    }
+    _mm_storeu_ps(r, hsum4SSE2(_mm_add_ps(s00, s01), _mm_add_ps(s10, s11), _mm_add_ps(s20, s21), _mm_add_ps(s30, s31)));
+    for (; i < n; ++i) {
+        float x = b[i];
+        r[0] += a0[i] * x;
+        r[1] += a1[i] * x;
+        r[2] += a2[i] * x;
+        r[3] += a3[i] * x;
+    }
+}
+
+__attribute__((target("sse2")))
+static void dotLanesSSE2(float *r, const float *h, const float *x, uint32_t n, uint32_t lanes, uint32_t stride)
+{
+    uint32_t c = 0;
+    for (; c + 4 <= lanes; c += 4) {
+        __m128 s0 = _mm_setzero_ps();
+        __m128 s1 = _mm_setzero_ps();
+        uint32_t k = 0;
+        for (; k + 2 <= n; k += 2) {
+            s0 = _mm_add_ps(s0, _mm_mul_ps(_mm_set1_ps(h[k]), _mm_loadu_ps(x + (size_t)k * stride + c)));
+            s1 = _mm_add_ps(s1, _mm_mul_ps(_mm_set1_ps(h[k + 1]), _mm_loadu_ps(x + (size_t)(k + 1) * stride + c)));
+        }
+        if (k < n)
+            s0 = _mm_add_ps(s0, _mm_mul_ps(_mm_set1_ps(h[k]), _mm_loadu_ps(x + (size_t)k * stride + c)));
+        _mm_storeu_ps(r + c, _mm_add_ps(s0, s1));
+    }
+    for (; c < lanes; ++c) {
+        float s = 0;
+        for (uint32_t k = 0; k < n; ++k)
+            s += h[k] * x[(size_t)k * stride + c];
+        r[c] = s;
+    }
+}
+
+__attribute__((target("sse2")))
+static void interpolateSSE2(float *r, const float *a, const float *b, float t, uint32_t n)
+{
+    __m128 vt = _mm_set1_ps(t);
+    uint32_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 va = _mm_loadu_ps(a + i);
+        __m128 vb = _mm_loadu_ps(b + i);
+        _mm_storeu_ps(r + i, _mm_add_ps(va, _mm_mul_ps(vt, _mm_sub_ps(vb, va))));
+    }
+    for (; i < n; ++i)
+        r[i] = a[i] + t * (b[i] - a[i]);
+}
+
+__attribute__((target("sse2")))
+static float dotSymmetricSSE2(const float *a, const float *b, const float *h, uint32_t n)
+{
+    __m128 s0 = _mm_setzero_ps();
+    __m128 s1 = _mm_setzero_ps();
+    uint32_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m128 vb0 = _mm_loadu_ps(b + n - 4 - i);
+        __m128 vb1 = _mm_loadu_ps(b + n - 8 - i);
+        vb0 = _mm_shuffle_ps(vb0, vb0, _MM_SHUFFLE(0, 1, 2, 3));
+        vb1 = _mm_shuffle_ps(vb1, vb1, _MM_SHUFFLE(0, 1, 2, 3));
+        s0 = _mm_add_ps(s0, _mm_mul_ps(_mm_loadu_ps(h + i), _mm_add_ps(_mm_loadu_ps(a + i), vb0)));
+        s1 = _mm_add_ps(s1, _mm_mul_ps(_mm_loadu_ps(h + i + 4), _mm_add_ps(_mm_loadu_ps(a + i + 4), vb1)));
+    }
+    for (; i + 4 <= n; i += 4) {
+        __m128 vb = _mm_loadu_ps(b + n - 4 - i);
+        vb = _mm_shuffle_ps(vb, vb, _MM_SHUFFLE(0, 1, 2, 3));
+        s0 = _mm_add_ps(s0, _mm_mul_ps(_mm_loadu_ps(h + i), _mm_add_ps(_mm_loadu_ps(a + i), vb)));
+    }
+    float s = hsumSSE2(_mm_add_ps(s0, s1));
+    for (; i < n; ++i)
+        s += h[i] * (a[i] + b[n - 1 - i]);
+    return s;
+}
+
+__attribute__((target("sse2")))
+static float dotReversedSSE2(const float *a, const float *b, uint32_t n)
+{
+    __m128 s0 = _mm_setzero_ps();
+    __m128 s1 = _mm_setzero_ps();
+    uint32_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m128 vb0 = _mm_loadu_ps(b + n - 4 - i);
+        __m128 vb1 = _mm_loadu_ps(b + n - 8 - i);
+        vb0 = _mm_shuffle_ps(vb0, vb0, _MM_SHUFFLE(0, 1, 2, 3));
+        vb1 = _mm_shuffle_ps(vb1, vb1, _MM_SHUFFLE(0, 1, 2, 3));
+        s0 = _mm_add_ps(s0, _mm_mul_ps(_mm_loadu_ps(a + i), vb0));
+        s1 = _mm_add_ps(s1, _mm_mul_ps(_mm_loadu_ps(a + i + 4), vb1));
+    }
+    for (; i + 4 <= n; i += 4) {
+        __m128 vb = _mm_loadu_ps(b + n - 4 - i);
+        vb = _mm_shuffle_ps(vb, vb, _MM_SHUFFLE(0, 1, 2, 3));
+        s0 = _mm_add_ps(s0, _mm_mul_ps(_mm_loadu_ps(a + i), vb));
+    }
+    float s = hsumSSE2(_mm_add_ps(s0, s1));
+    for (; i < n; ++i)
+        s += a[i] * b[n - 1 - i];
+    return s;
+}
+
+__attribute__((target("sse2")))
+static int32_t hsumInt32SSE2(__m128i v)
+{
+    v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2)));
+    v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(v);
+}
+
+__attribute__((target("sse2")))
+static int32_t dotInt16SSE2(const int16_t *a, const int16_t *b, uint32_t n)
+{
+    __m128i s0 = _mm_setzero_si128();
+    __m128i s1 = _mm_setzero_si128();
+    uint32_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        s0 = _mm_add_epi32(s0, _mm_madd_epi16(
+            _mm_loadu_si128((const __m128i *)(a + i)), _mm_loadu_si128((const __m128i *)(b + i))));
+        s1 = _mm_add_epi32(s1, _mm_madd_epi16(
+            _mm_loadu_si128((const __m128i *)(a + i + 8)), _mm_loadu_si128((const __m128i *)(b + i + 8))));
+    }
+    for (; i + 8 <= n; i += 8) {
+        s0 = _mm_add_epi32(s0, _mm_madd_epi16(
+            _mm_loadu_si128((const __m128i *)(a + i)), _mm_loadu_si128((const __m128i *)(b + i))));
+    }
+    uint32_t s = (uint32_t)hsumInt32SSE2(_mm_add_epi32(s0, s1));
+    for (; i < n; ++i)
+        s += (uint32_t)(a[i] * b[i]);
+    return (int32_t)s;
+}
+
+/**
+   Compute 8 lanes of `DotLanesInt16Function`, from the lane `c`
+   The samples of 2 frames are interleaved, so that each multiply-add of
+   16-bit pairs computes 2 taps of 4 lanes.
+ */
+__attribute__((target("sse2")))
+static void dotLanes8Int16SSE2(int32_t *r, const int16_t *h, const int16_t *x, uint32_t n, uint32_t stride)
+{
+    __m128i s0 = _mm_setzero_si128();
+    __m128i s1 = _mm_setzero_si128();
+    uint32_t k = 0;
+    for (; k + 2 <= n; k += 2) {
+        __m128i a = _mm_loadu_si128((const __m128i *)(x + (size_t)k * stride));
+        __m128i b = _mm_loadu_si128((const __m128i *)(x + (size_t)(k + 1) * stride));
+        __m128i hk = _mm_set1_epi32((int32_t)(((uint32_t)(uint16_t)h[k + 1] << 16) | (uint16_t)h[k]));
+        s0 = _mm_add_epi32(s0, _mm_madd_epi16(_mm_unpacklo_epi16(a, b), hk));
+        s1 = _mm_add_epi32(s1, _mm_madd_epi16(_mm_unpackhi_epi16(a, b), hk));
+    }
+    if (k < n) {
+        __m128i a = _mm_loadu_si128((const __m128i *)(x + (size_t)k * stride));
+        __m128i hk = _mm_set1_epi32((uint16_t)h[k]);
+        __m128i zero = _mm_setzero_si128();
+        s0 = _mm_add_epi32(s0, _mm_madd_epi16(_mm_unpacklo_epi16(a, zero), hk));
+        s1 = _mm_add_epi32(s1, _mm_madd_epi16(_mm_unpackhi_epi16(a, zero), hk));
+    }
+    _mm_storeu_si128((__m128i *)r, s0);
+    _mm_storeu_si128((__m128i *)(r + 4), s1);
+}
+
+__attribute__((target("sse2")))
+static void dotLanes4Int16SSE2(int32_t *r, const int16_t *h, const int16_t *x, uint32_t n, uint32_t stride)
+{
+    __m128i s0 = _mm_setzero_si128();
+    uint32_t k = 0;
+    for (; k + 2 <= n; k += 2) {
+        __m128i a = _mm_loadl_epi64((const __m128i *)(x + (size_t)k * stride));
+        __m128i b = _mm_loadl_epi64((const __m128i *)(x + (size_t)(k + 1) * stride));
+        __m128i hk = _mm_set1_epi32((int32_t)(((uint32_t)(uint16_t)h[k + 1] << 16) | (uint16_t)h[k]));
+        s0 = _mm_add_epi32(s0, _mm_madd_epi16(_mm_unpacklo_epi16(a, b), hk));
+    }
+    if (k < n) {
+        __m128i a = _mm_loadl_epi64((const __m128i *)(x + (size_t)k * stride));
+        __m128i hk = _mm_set1_epi32((uint16_t)h[k]);
+        s0 = _mm_add_epi32(s0, _mm_madd_epi16(_mm_unpacklo_epi16(a, _mm_setzero_si128()), hk));
+    }
+    _mm_storeu_si128((__m128i *)r, s0);
+}
+
+__attribute__((target("sse2")))
+static void dotLanesInt16SSE2(int32_t *r, const int16_t *h, const int16_t *x, uint32_t n, uint32_t lanes, uint32_t stride)
+{
+    uint32_t c = 0;
+    for (; c + 8 <= lanes; c += 8)
+        dotLanes8Int16SSE2(r + c, h, x + c, n, stride);
+    if (c + 4 <= lanes) {
+        dotLanes4Int16SSE2(r + c, h, x + c, n, stride);
+        c += 4;
+    }
+    if (c < lanes)
+        dotLanesInt16Scalar(r + c, h, x + c, n, lanes - c, stride);
+}
+
+__attribute__((target("sse2")))
+static void widenBFloat16SSE2(float *r, const uint16_t *a, uint32_t n)
+{
+    const __m128i zero = _mm_setzero_si128();
+    uint32_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(a + i));
+        _mm_storeu_ps(r + i, _mm_castsi128_ps(_mm_unpacklo_epi16(zero, v)));
+        _mm_storeu_ps(r + i + 4, _mm_castsi128_ps(_mm_unpackhi_epi16(zero, v)));
+    }
+    if (i < n)
+        widenBFloat16Scalar(r + i, a + i, n - i);
+}
+
+/**
+   Add the halves of a vector
+ */
+__attribute__((target("avx2,fma")))
+static __m128 foldAVX2(__m256 v)
+{
+    return _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+}
+
+__attribute__((target("avx2,fma")))
+static float dotAVX2(const float *a, const float *b, uint32_t n)
+{
+    __m256 s0 = _mm256_setzero_ps();
+    __m256 s1 = _mm256_setzero_ps();
+    uint32_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        s0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), s0);
+        s1 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8), s1);
+    }
+    for (; i + 8 <= n; i += 8)
+        s0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), s0);
+    __m128 v = foldAVX2(_mm256_add_ps(s0, s1));
+    for (; i + 4 <= n; i += 4)
+        v = _mm_fmadd_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i), v);
+    float s = hsumSSE2(v);
+    for (; i < n; ++i)
+        s += a[i] * b[i];
+    return s;
+}
+
+__attribute__((target("avx2,fma")))
+static void dot4AVX2(float *r, const float *const a[4], const float *b, uint32_t n)
+{
+    const float *a0 = a[0], *a1 = a[1], *a2 = a[2], *a3 = a[3];
+    // the accumulators of `dotAVX2`, for every row
+    __m256 s00 = _mm256_setzero_ps(), s01 = _mm256_setzero_ps();
+    __m256 s10 = _mm256_setzero_ps(), s11 = _mm256_setzero_ps();
+    __m256 s20 = _mm256_setzero_ps(), s21 = _mm256_setzero_ps();
+    __m256 s30 = _mm256_setzero_ps(), s31 = _mm256_setzero_ps();
+    uint32_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m256 x0 = _mm256_loadu_ps(b + i);
+        __m256 x1 = _mm256_loadu_ps(b + i + 8);
+        s00 = _mm256_fmadd_ps(_mm256_loadu_ps(a0 + i), x0, s00);
+        s01 = _mm256_fmadd_ps(_mm256_loadu_ps(a0 + i + 8), x1, s01);
+        s10 = _mm256_fmadd_ps(_mm256_loadu_ps(a1 + i), x0, s10);
+        s11 = _mm256_fmadd_ps(_mm256_loadu_ps(a1 + i + 8), x1, s11);
+        s20 = _mm256_fmadd_ps(_mm256_loadu_ps(a2 + i), x0, s20);
+        s21 = _mm256_fmadd_ps(_mm256_loadu_ps(a2 + i + 8), x1, s21);
+        s30 = _mm256_fmadd_ps(_mm256_loadu_ps(a3 + i), x0, s30);
+        s31 = _mm256_fmadd_ps(_mm256_loadu_ps(a3 + i + 8), x1, s31);
+    }
+    for (; i + 8 <= n; i += 8) {
+        __m256 x = _mm256_loadu_ps(b + i);
+        s00 = _mm256_fmadd_ps(_mm256_loadu_ps(a0 + i), x, s00);
+        s10 = _mm256_fmadd_ps(_mm256_loadu_ps(a1 + i), x, s10);
+        s20 = _mm256_fmadd_ps(_mm256_loadu_ps(a2 + i), x, s20);
+        s30 = _mm256_fmadd_ps(_mm256_loadu_ps(a3 + i), x, s30);
+    }
+    __m128 v0 = foldAVX2(_mm256_add_ps(s00, s01));
+    __m128 v1 = foldAVX2(_mm256_add_ps(s10, s11));
+    __m128 v2 = foldAVX2(_mm256_add_ps(s20, s21));
+    __m128 v3 = foldAVX2(_mm256_add_ps(s30, s31));
+    for (; i + 4 <= n; i += 4) {
+        __m128 x = _mm_loadu_ps(b + i);
+        v0 = _mm_fmadd_ps(_mm_loadu_ps(a0 + i), x, v0);
+        v1 = _mm_fmadd_ps(_mm_loadu_ps(a1 + i), x, v1);
+        v2 = _mm_fmadd_ps(_mm_loadu_ps(a2 + i), x, v2);
+        v3 = _mm_fmadd_ps(_mm_loadu_ps(a3 + i), x, v3);
+    }
+    _mm_storeu_ps(r, hsum4SSE2(v0, v1, v2, v3));
+    for (; i < n; ++i) {
+        float x = b[i];
+        r[0] += a0[i] * x;
+        r[1] += a1[i] * x;
+        r[2] += a2[i] * x;
+        r[3] += a3[i] * x;
+    }
+}
+
+__attribute__((target("avx2,fma")))
+static void dotLanesAVX2(float *r, const float *h, const float *x, uint32_t n, uint32_t lanes, uint32_t stride)
+{
+    uint32_t c = 0;
+    for (; c + 8 <= lanes; c += 8) {
+        __m256 s0 = _mm256_setzero_ps();
+        __m256 s1 = _mm256_setzero_ps();
+        uint32_t k = 0;
+        for (; k + 2 <= n; k += 2) {
+            s0 = _mm256_fmadd_ps(_mm256_set1_ps(h[k]), _mm256_loadu_ps(x + (size_t)k * stride + c), s0);
+            s1 = _mm256_fmadd_ps(_mm256_set1_ps(h[k + 1]), _mm256_loadu_ps(x + (size_t)(k + 1) * stride + c), s1);
+        }
+        if (k < n)
+            s0 = _mm256_fmadd_ps(_mm256_set1_ps(h[k]), _mm256_loadu_ps(x + (size_t)k * stride + c), s0);
+        _mm256_storeu_ps(r + c, _mm256_add_ps(s0, s1));
+    }
+    for (; c + 4 <= lanes; c += 4) {
+        __m128 s0 = _mm_setzero_ps();
+        for (uint32_t k = 0; k < n; ++k)
+            s0 = _mm_fmadd_ps(_mm_set1_ps(h[k]), _mm_loadu_ps(x + (size_t)k * stride + c), s0);
+        _mm_storeu_ps(r + c, s0);
+    }
+    for (; c < lanes; ++c) {
+        float s = 0;
+        for (uint32_t k = 0; k < n; ++k)
+            s += h[k] * x[(size_t)k * stride + c];
+        r[c] = s;
+    }
+}
+
+__attribute__((target("avx2,fma")))
+static void interpolateAVX2(float *r, const float *a, const float *b, float t, uint32_t n)
+{
+    __m256 vt = _mm256_set1_ps(t);
+    uint32_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 va = _mm256_loadu_ps(a + i);
+        __m256 vb = _mm256_loadu_ps(b + i);
+        _mm256_storeu_ps(r + i, _mm256_fmadd_ps(vt, _mm256_sub_ps(vb, va), va));
+    }
+    for (; i < n; ++i)
+        r[i] = a[i] + t * (b[i] - a[i]);
+}
+
+__attribute__((target("avx2,fma")))
+static float dotSymmetricAVX2(const float *a, const float *b, const float *h, uint32_t n)
+{
+    const __m256i reverse = _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0);
+    __m256 s0 = _mm256_setzero_ps();
+    __m256 s1 = _mm256_setzero_ps();
+    uint32_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m256 vb0 = _mm256_permutevar8x32_ps(_mm256_loadu_ps(b + n - 8 - i), reverse);
+        __m256 vb1 = _mm256_permutevar8x32_ps(_mm256_loadu_ps(b + n - 16 - i), reverse);
+        s0 = _mm256_fmadd_ps(_mm256_loadu_ps(h + i), _mm256_add_ps(_mm256_loadu_ps(a + i), vb0), s0);
+        s1 = _mm256_fmadd_ps(_mm256_loadu_ps(h + i + 8), _mm256_add_ps(_mm256_loadu_ps(a + i + 8), vb1), s1);
+    }
+    for (; i + 8 <= n; i += 8) {
+        __m256 vb = _mm256_permutevar8x32_ps(_mm256_loadu_ps(b + n - 8 - i), reverse);
+        s0 = _mm256_fmadd_ps(_mm256_loadu_ps(h + i), _mm256_add_ps(_mm256_loadu_ps(a + i), vb), s0);
+    }
+    __m128 v = foldAVX2(_mm256_add_ps(s0, s1));
+    for (; i + 4 <= n; i += 4) {
+        __m128 vb = _mm_loadu_ps(b + n - 4 - i);
+        vb = _mm_shuffle_ps(vb, vb, _MM_SHUFFLE(0, 1, 2, 3));
+        v = _mm_fmadd_ps(_mm_loadu_ps(h + i), _mm_add_ps(_mm_loadu_ps(a + i), vb), v);
+    }
+    float s = hsumSSE2(v);
+    for (; i < n; ++i)
+        s += h[i] * (a[i] + b[n - 1 - i]);
+    return s;
+}
+
+__attribute__((target("avx2,fma")))
+static float dotReversedAVX2(const float *a, const float *b, uint32_t n)
+{
+    const __m256i reverse = _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0);
+    __m256 s0 = _mm256_setzero_ps();
+    __m256 s1 = _mm256_setzero_ps();
+    uint32_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m256 vb0 = _mm256_permutevar8x32_ps(_mm256_loadu_ps(b + n - 8 - i), reverse);
+        __m256 vb1 = _mm256_permutevar8x32_ps(_mm256_loadu_ps(b + n - 16 - i), reverse);
+        s0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), vb0, s0);
+        s1 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 8), vb1, s1);
+    }
+    for (; i + 8 <= n; i += 8) {
+        __m256 vb = _mm256_permutevar8x32_ps(_mm256_loadu_ps(b + n - 8 - i), reverse);
+        s0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), vb, s0);
+    }
+    __m128 v = foldAVX2(_mm256_add_ps(s0, s1));
+    for (; i + 4 <= n; i += 4) {
+        __m128 vb = _mm_loadu_ps(b + n - 4 - i);
+        vb = _mm_shuffle_ps(vb, vb, _MM_SHUFFLE(0, 1, 2, 3));
+        v = _mm_fmadd_ps(_mm_loadu_ps(a + i), vb, v);
+    }
+    float s = hsumSSE2(v);
+    for (; i < n; ++i)
+        s += a[i] * b[n - 1 - i];
+    return s;
+}
+
+__attribute__((target("avx2")))
+static int32_t dotInt16AVX2(const int16_t *a, const int16_t *b, uint32_t n)
+{
+    __m256i s0 = _mm256_setzero_si256();
+    __m256i s1 = _mm256_setzero_si256();
+    uint32_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        s0 = _mm256_add_epi32(s0, _mm256_madd_epi16(
+            _mm256_loadu_si256((const __m256i *)(a + i)), _mm256_loadu_si256((const __m256i *)(b + i))));
+        s1 = _mm256_add_epi32(s1, _mm256_madd_epi16(
+            _mm256_loadu_si256((const __m256i *)(a + i + 16)), _mm256_loadu_si256((const __m256i *)(b + i + 16))));
+    }
+    for (; i + 16 <= n; i += 16) {
+        s0 = _mm256_add_epi32(s0, _mm256_madd_epi16(
+            _mm256_loadu_si256((const __m256i *)(a + i)), _mm256_loadu_si256((const __m256i *)(b + i))));
+    }
+    s0 = _mm256_add_epi32(s0, s1);
+    __m128i v = _mm_add_epi32(_mm256_castsi256_si128(s0), _mm256_extracti128_si256(s0, 1));
+    for (; i + 8 <= n; i += 8) {
+        __m128i va = _mm_loadu_si128((const __m128i *)(a + i));
+        __m128i vb = _mm_loadu_si128((const __m128i *)(b + i));
+        v = _mm_add_epi32(v, _mm_madd_epi16(va, vb));
+    }
+    uint32_t s = (uint32_t)hsumInt32SSE2(v);
+    for (; i < n; ++i)
+        s += (uint32_t)(a[i] * b[i]);
+    return (int32_t)s;
+}
+
+__attribute__((target("avx2")))
+static void dotLanesInt16AVX2(int32_t *r, const int16_t *h, const int16_t *x, uint32_t n, uint32_t lanes, uint32_t stride)
+{
+    uint32_t c = 0;
+    for (; c + 16 <= lanes; c += 16) {
+        __m256i s0 = _mm256_setzero_si256();
+        __m256i s1 = _mm256_setzero_si256();
+        uint32_t k = 0;
+        for (; k + 2 <= n; k += 2) {
+            __m256i a = _mm256_loadu_si256((const __m256i *)(x + (size_t)k * stride + c));
+            __m256i b = _mm256_loadu_si256((const __m256i *)(x + (size_t)(k + 1) * stride + c));
+            __m256i hk = _mm256_set1_epi32((int32_t)(((uint32_t)(uint16_t)h[k + 1] << 16) | (uint16_t)h[k]));
+            s0 = _mm256_add_epi32(s0, _mm256_madd_epi16(_mm256_unpacklo_epi16(a, b), hk));
+            s1 = _mm256_add_epi32(s1, _mm256_madd_epi16(_mm256_unpackhi_epi16(a, b), hk));
+        }
+        if (k < n) {
+            __m256i a = _mm256_loadu_si256((const __m256i *)(x + (size_t)k * stride + c));
+            __m256i hk = _mm256_set1_epi32((uint16_t)h[k]);
+            __m256i zero = _mm256_setzero_si256();
+            s0 = _mm256_add_epi32(s0, _mm256_madd_epi16(_mm256_unpacklo_epi16(a, zero), hk));
+            s1 = _mm256_add_epi32(s1, _mm256_madd_epi16(_mm256_unpackhi_epi16(a, zero), hk));
+        }
+        // the unpacking is by 128-bit halves: lanes 0-3 and 8-11 are in s0
+        _mm256_storeu_si256((__m256i *)(r + c), _mm256_permute2x128_si256(s0, s1, 0x20));
+        _mm256_storeu_si256((__m256i *)(r + c + 8), _mm256_permute2x128_si256(s0, s1, 0x31));
+    }
+    for (; c + 8 <= lanes; c += 8)
+        dotLanes8Int16SSE2(r + c, h, x + c, n, stride);
+    if (c + 4 <= lanes) {
+        dotLanes4Int16SSE2(r + c, h, x + c, n, stride);
+        c += 4;
+    }
+    if (c < lanes)
+        dotLanesInt16Scalar(r + c, h, x + c, n, lanes - c, stride);
+}
+
+__attribute__((target("avx2,f16c")))
+static void widenFloat16AVX2(float *r, const uint16_t *a, uint32_t n)
+{
+    uint32_t i = 0;
+    for (; i + 8 <= n; i += 8)
+        _mm256_storeu_ps(r + i, _mm256_cvtph_ps(_mm_loadu_si128((const __m128i *)(a + i))));
+    if (i < n)
+        widenFloat16Scalar(r + i, a + i, n - i);
+}
+
+__attribute__((target("avx2")))
+static void widenBFloat16AVX2(float *r, const uint16_t *a, uint32_t n)
+{
+    uint32_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i v = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *)(a + i)));
+        _mm256_storeu_ps(r + i, _mm256_castsi256_ps(_mm256_slli_epi32(v, 16)));
+    }
+    if (i < n)
+        widenBFloat16Scalar(r + i, a + i, n - i);
+}
+
+/**
+   Add the quarters of a vector
+ */
+__attribute__((target("avx512f")))
+static __m128 foldAVX512(__m512 v)
+{
+    __m256 t = _mm256_add_ps(_mm512_castps512_ps256(v), _mm256_castpd_ps(_mm512_extractf64x4_pd(_mm512_castps_pd(v), 1)));
+    return _mm_add_ps(_mm256_castps256_ps128(t), _mm256_extractf128_ps(t, 1));
+}
+
+__attribute__((target("avx512f")))
+static float dotAVX512(const float *a, const float *b, uint32_t n)
+{
+    __m512 s0 = _mm512_setzero_ps();
+    __m512 s1 = _mm512_setzero_ps();
+    uint32_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        s0 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i), s0);
+        s1 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i + 16), _mm512_loadu_ps(b + i + 16), s1);
+    }
+    for (; i + 16 <= n; i += 16)
+        s0 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i), s0);
+    if (i < n) {
+        __mmask16 m = (__mmask16)((1u << (n - i)) - 1);
+        s1 = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(m, a + i), _mm512_maskz_loadu_ps(m, b + i), s1);
+    }
+    return hsumSSE2(foldAVX512(_mm512_add_ps(s0, s1)));
+}
+
+__attribute__((target("avx512f")))
+static void dot4AVX512(float *r, const float *const a[4], const float *b, uint32_t n)
+{
+    const float *a0 = a[0], *a1 = a[1], *a2 = a[2], *a3 = a[3];
+    // the accumulators of `dotAVX512`, for every row
+    __m512 s00 = _mm512_setzero_ps(), s01 = _mm512_setzero_ps();
+    __m512 s10 = _mm512_setzero_ps(), s11 = _mm512_setzero_ps();
+    __m512 s20 = _mm512_setzero_ps(), s21 = _mm512_setzero_ps();
+    __m512 s30 = _mm512_setzero_ps(), s31 = _mm512_setzero_ps();
+    uint32_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m512 x0 = _mm512_loadu_ps(b + i);
+        __m512 x1 = _mm512_loadu_ps(b + i + 16);
+        s00 = _mm512_fmadd_ps(_mm512_loadu_ps(a0 + i), x0, s00);
+        s01 = _mm512_fmadd_ps(_mm512_loadu_ps(a0 + i + 16), x1, s01);
+        s10 = _mm512_fmadd_ps(_mm512_loadu_ps(a1 + i), x0, s10);
+        s11 = _mm512_fmadd_ps(_mm512_loadu_ps(a1 + i + 16), x1, s11);
+        s20 = _mm512_fmadd_ps(_mm512_loadu_ps(a2 + i), x0, s20);
+        s21 = _mm512_fmadd_ps(_mm512_loadu_ps(a2 + i + 16), x1, s21);
+        s30 = _mm512_fmadd_ps(_mm512_loadu_ps(a3 + i), x0, s30);
+        s31 = _mm512_fmadd_ps(_mm512_loadu_ps(a3 + i + 16), x1, s31);
+    }
+    for (; i + 16 <= n; i += 16) {
+        __m512 x = _mm512_loadu_ps(b + i);
+        s00 = _mm512_fmadd_ps(_mm512_loadu_ps(a0 + i), x, s00);
+        s10 = _mm512_fmadd_ps(_mm512_loadu_ps(a1 + i), x, s10);
+        s20 = _mm512_fmadd_ps(_mm512_loadu_ps(a2 + i), x, s20);
+        s30 = _mm512_fmadd_ps(_mm512_loadu_ps(a3 + i), x, s30);
+    }
+    if (i < n) {
+        __mmask16 m = (__mmask16)((1u << (n - i)) - 1);
+        __m512 x = _mm512_maskz_loadu_ps(m, b + i);
+        s01 = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(m, a0 + i), x, s01);
+        s11 = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(m, a1 + i), x, s11);
+        s21 = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(m, a2 + i), x, s21);
+        s31 = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(m, a3 + i), x, s31);
+    }
+    _mm_storeu_ps(r, hsum4SSE2(
+        foldAVX512(_mm512_add_ps(s00, s01)), foldAVX512(_mm512_add_ps(s10, s11)),
+        foldAVX512(_mm512_add_ps(s20, s21)), foldAVX512(_mm512_add_ps(s30, s31))));
+}
+
+__attribute__((target("avx512f")))
+static void dotLanesAVX512(float *r, const float *h, const float *x, uint32_t n, uint32_t lanes, uint32_t stride)
+{
+    for (uint32_t c = 0; c < lanes; c += 16) {
+        uint32_t rest = lanes - c;
+        __mmask16 m = (rest < 16) ? (__mmask16)((1u << rest) - 1) : (__mmask16)0xffff;
+        __m512 s0 = _mm512_setzero_ps();
+        __m512 s1 = _mm512_setzero_ps();
+        uint32_t k = 0;
+        for (; k + 2 <= n; k += 2) {
+            s0 = _mm512_fmadd_ps(_mm512_set1_ps(h[k]), _mm512_maskz_loadu_ps(m, x + (size_t)k * stride + c), s0);
+            s1 = _mm512_fmadd_ps(_mm512_set1_ps(h[k + 1]), _mm512_maskz_loadu_ps(m, x + (size_t)(k + 1) * stride + c), s1);
+        }
+        if (k < n)
+            s0 = _mm512_fmadd_ps(_mm512_set1_ps(h[k]), _mm512_maskz_loadu_ps(m, x + (size_t)k * stride + c), s0);
+        _mm512_mask_storeu_ps(r + c, m, _mm512_add_ps(s0, s1));
+    }
+}
+
+__attribute__((target("avx512f")))
+static void interpolateAVX512(float *r, const float *a, const float *b, float t, uint32_t n)
+{
+    __m512 vt = _mm512_set1_ps(t);
+    uint32_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m512 va = _mm512_loadu_ps(a + i);
+        __m512 vb = _mm512_loadu_ps(b + i);
+        _mm512_storeu_ps(r + i, _mm512_fmadd_ps(vt, _mm512_sub_ps(vb, va), va));
+    }
+    if (i < n) {
+        __mmask16 m = (__mmask16)((1u << (n - i)) - 1);
+        __m512 va = _mm512_maskz_loadu_ps(m, a + i);
+        __m512 vb = _mm512_maskz_loadu_ps(m, b + i);
+        _mm512_mask_storeu_ps(r + i, m, _mm512_fmadd_ps(vt, _mm512_sub_ps(vb, va), va));
+    }
+}
+
+__attribute__((target("avx512f")))
+static float dotSymmetricAVX512(const float *a, const float *b, const float *h, uint32_t n)
+{
+    const __m512i reverse = _mm512_setr_epi32(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+    __m512 s0 = _mm512_setzero_ps();
+    __m512 s1 = _mm512_setzero_ps();
+    uint32_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m512 vb0 = _mm512_permutexvar_ps(reverse, _mm512_loadu_ps(b + n - 16 - i));
+        __m512 vb1 = _mm512_permutexvar_ps(reverse, _mm512_loadu_ps(b + n - 32 - i));
+        s0 = _mm512_fmadd_ps(_mm512_loadu_ps(h + i), _mm512_add_ps(_mm512_loadu_ps(a + i), vb0), s0);
+        s1 = _mm512_fmadd_ps(_mm512_loadu_ps(h + i + 16), _mm512_add_ps(_mm512_loadu_ps(a + i + 16), vb1), s1);
+    }
+    for (; i + 16 <= n; i += 16) {
+        __m512 vb = _mm512_permutexvar_ps(reverse, _mm512_loadu_ps(b + n - 16 - i));
+        s0 = _mm512_fmadd_ps(_mm512_loadu_ps(h + i), _mm512_add_ps(_mm512_loadu_ps(a + i), vb), s0);
+    }
+    if (i < n) {
+        // the rest of b is at its start: the lane j takes b[rest - 1 - j],
+        // and the lanes past the rest are cancelled by the zeros of h
+        uint32_t rest = n - i;
+        __mmask16 m = (__mmask16)((1u << rest) - 1);
+        __m512i index = _mm512_sub_epi32(_mm512_set1_epi32((int)rest - 1), _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15));
+        __m512 vb = _mm512_permutexvar_ps(index, _mm512_maskz_loadu_ps(m, b));
+        s1 = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(m, h + i), _mm512_add_ps(_mm512_maskz_loadu_ps(m, a + i), vb), s1);
+    }
+    return hsumSSE2(foldAVX512(_mm512_add_ps(s0, s1)));
+}
+
+__attribute__((target("avx512f")))
+static float dotReversedAVX512(const float *a, const float *b, uint32_t n)
+{
+    const __m512i reverse = _mm512_setr_epi32(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+    __m512 s0 = _mm512_setzero_ps();
+    __m512 s1 = _mm512_setzero_ps();
+    uint32_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m512 vb0 = _mm512_permutexvar_ps(reverse, _mm512_loadu_ps(b + n - 16 - i));
+        __m512 vb1 = _mm512_permutexvar_ps(reverse, _mm512_loadu_ps(b + n - 32 - i));
+        s0 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i), vb0, s0);
+        s1 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i + 16), vb1, s1);
+    }
+    for (; i + 16 <= n; i += 16) {
+        __m512 vb = _mm512_permutexvar_ps(reverse, _mm512_loadu_ps(b + n - 16 - i));
+        s0 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i), vb, s0);
+    }
+    if (i < n) {
+        // as in `dotSymmetricAVX512`, the rest of b is at its start
+        uint32_t rest = n - i;
+        __mmask16 m = (__mmask16)((1u << rest) - 1);
+        __m512i index = _mm512_sub_epi32(_mm512_set1_epi32((int)rest - 1), _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15));
+        __m512 vb = _mm512_permutexvar_ps(index, _mm512_maskz_loadu_ps(m, b));
+        s1 = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(m, a + i), vb, s1);
+    }
+    return hsumSSE2(foldAVX512(_mm512_add_ps(s0, s1)));
+}
+
+__attribute__((target("avx512f")))
+static void widenFloat16AVX512(float *r, const uint16_t *a, uint32_t n)
+{
+    uint32_t i = 0;
+    for (; i + 16 <= n; i += 16)
+        _mm512_storeu_ps(r + i, _mm512_cvtph_ps(_mm256_loadu_si256((const __m256i *)(a + i))));
+    if (i < n)
+        widenFloat16Scalar(r + i, a + i, n - i);
+}
+
+__attribute__((target("avx512f")))
+static void widenBFloat16AVX512(float *r, const uint16_t *a, uint32_t n)
+{
+    uint32_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m512i v = _mm512_cvtepu16_epi32(_mm256_loadu_si256((const __m256i *)(a + i)));
+        _mm512_storeu_ps(r + i, _mm512_castsi512_ps(_mm512_slli_epi32(v, 16)));
+    }
+    if (i < n)
+        widenBFloat16Scalar(r + i, a + i, n - i);
+}
+
+static const Functions sSSE2 = {
+    Isa::SSE2,
+    &dotSSE2,
+    &dot4SSE2,
+    &dotLanesSSE2,
+    &interpolateSSE2,
+    &dotSymmetricSSE2,
+    &dotReversedSSE2,
+    &dotInt16SSE2,
+    &dotLanesInt16SSE2,
+    &widenFloat16Scalar, // the conversion instructions come with AVX
+    &widenBFloat16SSE2,
+};
+
+static const Functions sAVX2 = {
+    Isa::AVX2,
+    &dotAVX2,
+    &dot4AVX2,
+    &dotLanesAVX2,
+    &interpolateAVX2,
+    &dotSymmetricAVX2,
+    &dotReversedAVX2,
+    &dotInt16AVX2,
+    &dotLanesInt16AVX2,
+    &widenFloat16AVX2,
+    &widenBFloat16AVX2,
+};
+
+static const Functions sAVX512 = {
+    Isa::AVX512,
+    &dotAVX512,
+    &dot4AVX512,
+    &dotLanesAVX512,
+    &interpolateAVX512,
+    &dotSymmetricAVX512,
+    &dotReversedAVX512,
+    &dotInt16AVX2, // 16-bit multiply-add is in AVX-512BW, not AVX-512F
+    &dotLanesInt16AVX2,
+    &widenFloat16AVX512,
+    &widenBFloat16AVX512,
+};
+#endif
+
+//------------------------------------------------------------------------------
+// ARM
+//
+// These are not compiled by the checks of an x86 build: they have been
+// compared to the scalar functions only on an emulation of the intrinsics.
+
+#if defined(RESAMPLER_SIMD_NEON)
+static float dotNEON(const float *a, const float *b, uint32_t n)
+{
+    float32x4_t s0 = vdupq_n_f32(0);
+    float32x4_t s1 = vdupq_n_f32(0);
+    uint32_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+#if defined(__aarch64__)
+        s0 = vfmaq_f32(s0, vld1q_f32(a + i), vld1q_f32(b + i));
+        s1 = vfmaq_f32(s1, vld1q_f32(a + i + 4), vld1q_f32(b + i + 4));
+#else
+        s0 = vmlaq_f32(s0, vld1q_f32(a + i), vld1q_f32(b + i));
+        s1 = vmlaq_f32(s1, vld1q_f32(a + i + 4), vld1q_f32(b + i + 4));
+#endif
+    }
+    for (; i + 4 <= n; i += 4)
+        s0 = vmlaq_f32(s0, vld1q_f32(a + i), vld1q_f32(b + i));
+    s0 = vaddq_f32(s0, s1);
+    float32x2_t v = vadd_f32(vget_low_f32(s0), vget_high_f32(s0));
+    float s = vget_lane_f32(vpadd_f32(v, v), 0);
+    for (; i < n; ++i)
+        s += a[i] * b[i];
+    return s;
+}
+
+static void dot4NEON(float *r, const float *const a[4], const float *b, uint32_t n)
+{
+    const float *a0 = a[0], *a1 = a[1], *a2 = a[2], *a3 = a[3];
+    // the accumulators of `dotNEON`, for every row
+    float32x4_t s00 = vdupq_n_f32(0), s01 = vdupq_n_f32(0);
+    float32x4_t s10 = vdupq_n_f32(0), s11 = vdupq_n_f32(0);
+    float32x4_t s20 = vdupq_n_f32(0), s21 = vdupq_n_f32(0);
+    float32x4_t s30 = vdupq_n_f32(0), s31 = vdupq_n_f32(0);
+    uint32_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        float32x4_t x0 = vld1q_f32(b + i);
+        float32x4_t x1 = vld1q_f32(b + i + 4);
+#if defined(__aarch64__)
+        s00 = vfmaq_f32(s00, vld1q_f32(a0 + i), x0);
+        s01 = vfmaq_f32(s01, vld1q_f32(a0 + i + 4), x1);
+        s10 = vfmaq_f32(s10, vld1q_f32(a1 + i), x0);
+        s11 = vfmaq_f32(s11, vld1q_f32(a1 + i + 4), x1);
+        s20 = vfmaq_f32(s20, vld1q_f32(a2 + i), x0);
+        s21 = vfmaq_f32(s21, vld1q_f32(a2 + i + 4), x1);
+        s30 = vfmaq_f32(s30, vld1q_f32(a3 + i), x0);
+        s31 = vfmaq_f32(s31, vld1q_f32(a3 + i + 4), x1);
+#else
+        s00 = vmlaq_f32(s00, vld1q_f32(a0 + i), x0);
+        s01 = vmlaq_f32(s01, vld1q_f32(a0 + i + 4), x1);
+        s10 = vmlaq_f32(s10, vld1q_f32(a1 + i), x0);
+        s11 = vmlaq_f32(s11, vld1q_f32(a1 + i + 4), x1);
+        s20 = vmlaq_f32(s20, vld1q_f32(a2 + i), x0);
+        s21 = vmlaq_f32(s21, vld1q_f32(a2 + i + 4), x1);
+        s30 = vmlaq_f32(s30, vld1q_f32(a3 + i), x0);
+        s31 = vmlaq_f32(s31, vld1q_f32(a3 + i + 4), x1);
+#endif
+    }
+    for (; i + 4 <= n; i += 4) {
+        float32x4_t x = vld1q_f32(b + i);
+        s00 = vmlaq_f32(s00, vld1q_f32(a0 + i), x);
+        s10 = vmlaq_f32(s10, vld1q_f32(a1 + i), x);
+        s20 = vmlaq_f32(s20, vld1q_f32(a2 + i), x);
+        s30 = vmlaq_f32(s30, vld1q_f32(a3 + i), x);
+    }
+    s00 = vaddq_f32(s00, s01);
+    s10 = vaddq_f32(s10, s11);
+    s20 = vaddq_f32(s20, s21);
+    s30 = vaddq_f32(s30, s31);
+    float32x2_t v0 = vadd_f32(vget_low_f32(s00), vget_high_f32(s00));
+    float32x2_t v1 = vadd_f32(vget_low_f32(s10), vget_high_f32(s10));
+    float32x2_t v2 = vadd_f32(vget_low_f32(s20), vget_high_f32(s20));
+    float32x2_t v3 = vadd_f32(vget_low_f32(s30), vget_high_f32(s30));
+    vst1q_f32(r, vcombine_f32(vpadd_f32(v0, v1), vpadd_f32(v2, v3)));
+    for (; i < n; ++i) {
+        float x = b[i];
+        r[0] += a0[i] * x;
+        r[1] += a1[i] * x;
+        r[2] += a2[i] * x;
+        r[3] += a3[i] * x;
+    }
+}
+
+static void dotLanesNEON(float *r, const float *h, const float *x, uint32_t n, uint32_t lanes, uint32_t stride)
+{
+    uint32_t c = 0;
+    for (; c + 4 <= lanes; c += 4) {
+        float32x4_t s0 = vdupq_n_f32(0);
+        float32x4_t s1 = vdupq_n_f32(0);
+        uint32_t k = 0;
+        for (; k + 2 <= n; k += 2) {
+            s0 = vmlaq_n_f32(s0, vld1q_f32(x + (size_t)k * stride + c), h[k]);
+            s1 = vmlaq_n_f32(s1, vld1q_f32(x + (size_t)(k + 1) * stride + c), h[k + 1]);
+        }
+        if (k < n)
+            s0 = vmlaq_n_f32(s0, vld1q_f32(x + (size_t)k * stride + c), h[k]);
+        vst1q_f32(r + c, vaddq_f32(s0, s1));
+    }
+    for (; c < lanes; ++c) {
+        float s = 0;
+        for (uint32_t k = 0; k < n; ++k)
+            s += h[k] * x[(size_t)k * stride + c];
+        r[c] = s;
+    }
+}
+
+static void interpolateNEON(float *r, const float *a, const float *b, float t, uint32_t n)
+{
+    uint32_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        float32x4_t va = vld1q_f32(a + i);
+        float32x4_t vb = vld1q_f32(b + i);
+        vst1q_f32(r + i, vmlaq_n_f32(va, vsubq_f32(vb, va), t));
+    }
+    for (; i < n; ++i)
+        r[i] = a[i] + t * (b[i] - a[i]);
+}
+
+static float dotSymmetricNEON(const float *a, const float *b, const float *h, uint32_t n)
+{
+    float32x4_t s0 = vdupq_n_f32(0);
+    float32x4_t s1 = vdupq_n_f32(0);
+    uint32_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        float32x4_t vb0 = vrev64q_f32(vld1q_f32(b + n - 4 - i));
+        float32x4_t vb1 = vrev64q_f32(vld1q_f32(b + n - 8 - i));
+        vb0 = vcombine_f32(vget_high_f32(vb0), vget_low_f32(vb0));
+        vb1 = vcombine_f32(vget_high_f32(vb1), vget_low_f32(vb1));
+        s0 = vmlaq_f32(s0, vld1q_f32(h + i), vaddq_f32(vld1q_f32(a + i), vb0));
+        s1 = vmlaq_f32(s1, vld1q_f32(h + i + 4), vaddq_f32(vld1q_f32(a + i + 4), vb1));
+    }
+    for (; i + 4 <= n; i += 4) {
+        float32x4_t vb = vrev64q_f32(vld1q_f32(b + n - 4 - i));
+        vb = vcombine_f32(vget_high_f32(vb), vget_low_f32(vb));
+        s0 = vmlaq_f32(s0, vld1q_f32(h + i), vaddq_f32(vld1q_f32(a + i), vb));
+    }
+    s0 = vaddq_f32(s0, s1);
+    float32x2_t v = vadd_f32(vget_low_f32(s0), vget_high_f32(s0));
+    float s = vget_lane_f32(vpadd_f32(v, v), 0);
+    for (; i < n; ++i)
+        s += h[i] * (a[i] + b[n - 1 - i]);
+    return s;
+}
+
+static float dotReversedNEON(const float *a, const float *b, uint32_t n)
+{
+    float32x4_t s0 = vdupq_n_f32(0);
+    float32x4_t s1 = vdupq_n_f32(0);
+    uint32_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        float32x4_t vb0 = vrev64q_f32(vld1q_f32(b + n - 4 - i));
+        float32x4_t vb1 = vrev64q_f32(vld1q_f32(b + n - 8 - i));
+        vb0 = vcombine_f32(vget_high_f32(vb0), vget_low_f32(vb0));
+        vb1 = vcombine_f32(vget_high_f32(vb1), vget_low_f32(vb1));
+        s0 = vmlaq_f32(s0, vld1q_f32(a + i), vb0);
+        s1 = vmlaq_f32(s1, vld1q_f32(a + i + 4), vb1);
+    }
+    for (; i + 4 <= n; i += 4) {
+        float32x4_t vb = vrev64q_f32(vld1q_f32(b + n - 4 - i));
+        vb = vcombine_f32(vget_high_f32(vb), vget_low_f32(vb));
+        s0 = vmlaq_f32(s0, vld1q_f32(a + i), vb);
+    }
+    s0 = vaddq_f32(s0, s1);
+    float32x2_t v = vadd_f32(vget_low_f32(s0), vget_high_f32(s0));
+    float s = vget_lane_f32(vpadd_f32(v, v), 0);
+    for (; i < n; ++i)
+        s += a[i] * b[n - 1 - i];
+    return s;
+}
+
+static int32_t dotInt16NEON(const int16_t *a, const int16_t *b, uint32_t n)
+{
+    int32x4_t s0 = vdupq_n_s32(0);
+    int32x4_t s1 = vdupq_n_s32(0);
+    uint32_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        int16x8_t va = vld1q_s16(a + i);
+        int16x8_t vb = vld1q_s16(b + i);
+        s0 = vmlal_s16(s0, vget_low_s16(va), vget_low_s16(vb));
+        s1 = vmlal_s16(s1, vget_high_s16(va), vget_high_s16(vb));
+    }
+    s0 = vaddq_s32(s0, s1);
+    int32x2_t v = vadd_s32(vget_low_s32(s0), vget_high_s32(s0));
+    uint32_t s = (uint32_t)vget_lane_s32(vpadd_s32(v, v), 0);
+    for (; i < n; ++i)
+        s += (uint32_t)(a[i] * b[i]);
+    return (int32_t)s;
+}
+
+static void dotLanesInt16NEON(int32_t *r, const int16_t *h, const int16_t *x, uint32_t n, uint32_t lanes, uint32_t stride)
+{
+    uint32_t c = 0;
+    for (; c + 8 <= lanes; c += 8) {
+        int32x4_t s0 = vdupq_n_s32(0);
+        int32x4_t s1 = vdupq_n_s32(0);
+        for (uint32_t k = 0; k < n; ++k) {
+            int16x8_t v = vld1q_s16(x + (size_t)k * stride + c);
+            s0 = vmlal_n_s16(s0, vget_low_s16(v), h[k]);
+            s1 = vmlal_n_s16(s1, vget_high_s16(v), h[k]);
+        }
+        vst1q_s32(r + c, s0);
+        vst1q_s32(r + c + 4, s1);
+    }
+    for (; c + 4 <= lanes; c += 4) {
+        int32x4_t s0 = vdupq_n_s32(0);
+        for (uint32_t k = 0; k < n; ++k)
+            s0 = vmlal_n_s16(s0, vld1_s16(x + (size_t)k * stride + c), h[k]);
+        vst1q_s32(r + c, s0);
+    }
+    if (c < lanes)
+        dotLanesInt16Scalar(r + c, h, x + c, n, lanes - c, stride);
+}
+
+static void widenFloat16NEON(float *r, const uint16_t *a, uint32_t n)
+{
+    uint32_t i = 0;
+#if defined(__aarch64__)
+    for (; i + 4 <= n; i += 4)
+        vst1q_f32(r + i, vcvt_f32_f16(vreinterpret_f16_u16(vld1_u16(a + i))));
+#endif
+    if (i < n)
+        widenFloat16Scalar(r + i, a + i, n - i);
+}
+
+static void widenBFloat16NEON(float *r, const uint16_t *a, uint32_t n)
+{
+    uint32_t i = 0;
+    for (; i + 4 <= n; i += 4)
+        vst1q_f32(r + i, vreinterpretq_f32_u32(vshll_n_u16(vld1_u16(a + i), 16)));
+    if (i < n)
+        widenBFloat16Scalar(r + i, a + i, n - i);
+}
+
+static const Functions sNEON = {
+    Isa::NEON,
+    &dotNEON,
+    &dot4NEON,
+    &dotLanesNEON,
+    &interpolateNEON,
+    &dotSymmetricNEON,
+    &dotReversedNEON,
+    &dotInt16NEON,
+    &dotLanesInt16NEON,
+    &widenFloat16NEON,
+    &widenBFloat16NEON,
+};
+#endif
+
+//------------------------------------------------------------------------------
+// Dispatch
+
+const Functions *functions(Isa isa)
+{
+    switch (isa) {
+    case Isa::Scalar:
+        return &sScalar;
+#if defined(RESAMPLER_SIMD_X86)
+    case Isa::SSE2:
+        return __builtin_cpu_supports("sse2") ? &sSSE2 : nullptr;
+    case Isa::AVX2:
+        return (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma") && __builtin_cpu_supports("f16c")) ? &sAVX2 : nullptr;
+    case Isa::AVX512:
+        // the table has kernels of AVX2
+        return (__builtin_cpu_supports("avx512f") && functions(Isa::AVX2)) ? &sAVX512 : nullptr;
+#endif
+#if defined(RESAMPLER_SIMD_NEON)
+    case Isa::NEON:
+        return &sNEON;
+#endif
+    default:
+        return nullptr;
+    }
+}
+
+static const Functions &detectFunctions()
+{
+    const Isa preference[] = {Isa::AVX512, Isa::AVX2, Isa::SSE2, Isa::NEON};
+    for (Isa isa : preference) {
+        if (const Functions *f = functions(isa))
+            return *f;
+    }
+    return sScalar;
+}
+
+const Functions &functions()
+{
+    static const Functions &f = detectFunctions();
+    return f;
+}
+
+const char *isaName(Isa isa)
+{
+    switch (isa) {
+    case Isa::Scalar:
+        return "scalar";
+    case Isa::SSE2:
+        return "sse2";
+    case Isa::AVX2:
+        return "avx2";
+    case Isa::AVX512:
+        return "avx512";
+    case Isa::NEON:
+        return "neon";
+    default:
+        return "unknown";
+    }
+}
+
+} // namespace ResamplerSIMD
@@ -0,0 +1,123 @@
+#pragma once
+#include <cstdint>
+
+/**
+   Vectorized primitives for the resampler, selected at runtime
+
+   Every primitive exists in a portable scalar version, and in versions
+   specialized for instruction sets which may or may not be available on the
+   host. The best supported version is identified once on first use, so that
+   a single binary runs optimally on any processor of its architecture.
+ */
+namespace ResamplerSIMD {
+    /**
+       Instruction set of a group of primitives
+     */
+    enum class Isa {
+        Scalar,
+        SSE2,
+        AVX2,   // with FMA and F16C
+        AVX512, // AVX-512F, with the extensions of AVX2
+        NEON,
+    };
+
+    /**
+       Compute the dot product of `a` and `b`, vectors of `n` elements.
+       There is no alignment requirement on the pointers.
+     */
+    typedef float (DotFunction)(const float *a, const float *b, uint32_t n);
+
+    /**
+       Compute 4 dot products of the vectors `a[j]` with the same vector `b`,
+       of `n` elements, into `r[j]`. The loads of `b` are shared, and the 4
+       horizontal sums are merged into one.
+       Every `r[j]` is bit-identical to the `DotFunction` of the same
+       instruction set, so the output does not depend on the batching.
+       There is no alignment requirement on the pointers.
+     */
+    typedef void (Dot4Function)(float *r, const float *const a[4], const float *b, uint32_t n);
+
+    /**
+       Compute the dot products of `h`, a vector of `n` elements, with the
+       first `lanes` columns of `x`, a matrix of `n` rows spaced by `stride`,
+       into `r[c]`: sum(h[k] * x[k * stride + c]). Every coefficient of `h`
+       is broadcast to the lanes, without horizontal sums.
+       There is no alignment requirement on the pointers.
+     */
+    typedef void (DotLanesFunction)(float *r, const float *h, const float *x, uint32_t n, uint32_t lanes, uint32_t stride);
+
+    /**
+       Compute the linear interpolation `r = a + t * (b - a)`, of vectors of
+       `n` elements. There is no alignment requirement on the pointers.
+     */
+    typedef void (InterpolateFunction)(float *r, const float *a, const float *b, float t, uint32_t n);
+
+    /**
+       Compute the dot product of `h` with the sum of `a` and reversed `b`,
+       vectors of `n` elements: sum(h[i] * (a[i] + b[n - 1 - i])).
+       It evaluates a symmetric filter of 2n taps with n multiplications.
+       There is no alignment requirement on the pointers.
+     */
+    typedef float (DotSymmetricFunction)(const float *a, const float *b, const float *h, uint32_t n);
+
+    /**
+       Compute the dot product of `a` and reversed `b`, vectors of `n`
+       elements: sum(a[i] * b[n - 1 - i]). It convolves with the mirror of a
+       kernel row, without a copy of the row.
+       There is no alignment requirement on the pointers.
+     */
+    typedef float (DotReversedFunction)(const float *a, const float *b, uint32_t n);
+
+    /**
+       Compute the dot product of `a` and `b`, vectors of `n` 16-bit
+       integers, into a 32-bit accumulator which wraps on overflow.
+       There is no alignment requirement on the pointers.
+     */
+    typedef int32_t (DotInt16Function)(const int16_t *a, const int16_t *b, uint32_t n);
+
+    /**
+       Compute the dot products of `h` with the columns of `x`, like
+       `DotLanesFunction`, with 16-bit integers, into 32-bit accumulators
+       which wrap on overflow.
+     */
+    typedef void (DotLanesInt16Function)(int32_t *r, const int16_t *h, const int16_t *x, uint32_t n, uint32_t lanes, uint32_t stride);
+
+    /**
+       Convert `n` 16-bit floating point numbers of `a` to floats, into `r`.
+       There is no alignment requirement on the pointers.
+     */
+    typedef void (WidenFunction)(float *r, const uint16_t *a, uint32_t n);
+
+    /**
+       Set of primitives for a particular instruction set
+     */
+    struct Functions {
+        Isa isa;
+        DotFunction *dot;
+        Dot4Function *dot4;
+        DotLanesFunction *dotLanes;
+        InterpolateFunction *interpolate;
+        DotSymmetricFunction *dotSymmetric;
+        DotReversedFunction *dotReversed;
+        DotInt16Function *dotInt16;
+        DotLanesInt16Function *dotLanesInt16;
+        WidenFunction *widenFloat16;
+        WidenFunction *widenBFloat16;
+    };
+
+    /**
+       Get the best primitives supported by the processor.
+     */
+    const Functions &functions();
+
+    /**
+       Get the primitives for a particular instruction set, or null if it is
+       not supported by this build or by the processor.
+     */
+    const Functions *functions(Isa isa);
+
+    /**
+       Get the name of an instruction set.
+     */
+    const char *isaName(Isa isa);
+};
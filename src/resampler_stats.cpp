@@ -0,0 +1,95 @@
+#include "resampler_stats.h"
+#include <chrono>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HAVE_RDTSC 1
+#endif
+
+uint64_t ResamplerStats::now()
+{
+#if defined(HAVE_RDTSC)
+    return __rdtsc();
+#else
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+ResamplerStats &ResamplerStats::operator+=(const ResamplerStats &other)
+{
+    calls += other.calls;
+    inputFrames += other.inputFrames;
+    outputFrames += other.outputFrames;
+    ingestCycles += other.ingestCycles;
+    convolveCycles += other.convolveCycles;
+    callbackCycles += other.callbackCycles;
+    return *this;
+}
+
+/**
+   Write a string as a JSON string, with its quotes
+ */
+static void printString(FILE *file, const char *text)
+{
+    fputc('"', file);
+    for (const char *p = text; *p; ++p) {
+        unsigned char c = (unsigned char)*p;
+        if (c == '"' || c == '\\')
+            fprintf(file, "\\%c", c);
+        else if (c < 0x20)
+            fprintf(file, "\\u%04x", c);
+        else
+            fputc(c, file);
+    }
+    fputc('"', file);
+}
+
+void ResamplerStats::print(FILE *file, const char *label) const
+{
+    uint64_t cycles = ingestCycles + convolveCycles;
+    double perFrame = outputFrames ? (double)cycles / outputFrames : 0;
+
+    fprintf(file, "{\"label\": ");
+    printString(file, label);
+    fprintf(file, ", \"calls\": %llu, \"input_frames\": %llu, "
+            "\"output_frames\": %llu, \"ingest_cycles\": %llu, \"convolve_cycles\": %llu, "
+            "\"callback_cycles\": %llu, \"cycles_per_frame\": %.2f}",
+            (unsigned long long)calls, (unsigned long long)inputFrames,
+            (unsigned long long)outputFrames, (unsigned long long)ingestCycles,
+            (unsigned long long)convolveCycles, (unsigned long long)callbackCycles,
+            perFrame);
+}
+
+//------------------------------------------------------------------------------
+
+void ResamplerStatsRegistry::add(const std::string &label, const ResamplerStats &stats)
+{
+    std::lock_guard<std::mutex> lock(fMutex);
+    fTotals[label] += stats;
+}
+
+std::map<std::string, ResamplerStats> ResamplerStatsRegistry::totals() const
+{
+    std::lock_guard<std::mutex> lock(fMutex);
+    return fTotals;
+}
+
+void ResamplerStatsRegistry::print(FILE *file) const
+{
+    std::map<std::string, ResamplerStats> totals = this->totals();
+
+    fprintf(file, "[");
+    bool first = true;
+    for (const auto &entry : totals) {
+        fprintf(file, "%s\n  ", first ? "" : ",");
+        entry.second.print(file, entry.first.c_str());
+        first = false;
+    }
+    fprintf(file, "\n]\n");
+}
+
+void ResamplerStatsRegistry::clear()
+{
+    std::lock_guard<std::mutex> lock(fMutex);
+    fTotals.clear();
+}
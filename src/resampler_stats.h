@@ -0,0 +1,127 @@
+#pragma once
+#include <map>
+#include <mutex>
+#include <string>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+/**
+   Performance counters of a resampler
+
+   They are collected only in the builds which define
+   `RESAMPLER_INSTRUMENTATION`, otherwise they stay zero and the hooks
+   compile to nothing. The times are in cycles of the time stamp counter, or
+   in nanoseconds on the machines without one.
+ */
+struct ResamplerStats {
+    uint64_t calls = 0;          // runs of the resampling loop
+    uint64_t inputFrames = 0;    // frames consumed
+    uint64_t outputFrames = 0;   // frames produced
+    uint64_t ingestCycles = 0;   // input into the history
+    uint64_t convolveCycles = 0; // kernel rows and convolutions
+    uint64_t callbackCycles = 0; // in the functions of `Resampler::resample`,
+                                 // which is part of the times above
+
+    /**
+       Get whether the counters are collected in this build.
+     */
+    static constexpr bool enabled()
+    {
+#if defined(RESAMPLER_INSTRUMENTATION)
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    /**
+       Read the clock of the timers.
+     */
+    static uint64_t now();
+
+    ResamplerStats &operator+=(const ResamplerStats &other);
+
+    /**
+       Write the counters as a JSON object, on one line.
+     */
+    void print(FILE *file, const char *label) const;
+};
+
+/**
+   Hooks of the instrumentation in a resampler, which do nothing unless it
+   is enabled
+
+   A timer is a time stamp, which every hook moves to the present after
+   adding the time elapsed to its counter.
+ */
+class ResamplerCounters {
+public:
+#if defined(RESAMPLER_INSTRUMENTATION)
+    uint64_t start() const { return ResamplerStats::now(); }
+    void ingest(uint64_t &timer) { lap(timer, fStats.ingestCycles); }
+    void convolve(uint64_t &timer) { lap(timer, fStats.convolveCycles); }
+    void callback(uint64_t &timer) { lap(timer, fStats.callbackCycles); }
+
+    void count(size_t consumed, size_t produced)
+    {
+        fStats.calls += 1;
+        fStats.inputFrames += consumed;
+        fStats.outputFrames += produced;
+    }
+
+    const ResamplerStats &stats() const { return fStats; }
+    void reset() { fStats = ResamplerStats(); }
+
+private:
+    static void lap(uint64_t &timer, uint64_t &counter)
+    {
+        uint64_t t = ResamplerStats::now();
+        counter += t - timer;
+        timer = t;
+    }
+
+    ResamplerStats fStats;
+#else
+    uint64_t start() const { return 0; }
+    void ingest(uint64_t &) {}
+    void convolve(uint64_t &) {}
+    void callback(uint64_t &) {}
+    void count(size_t, size_t) {}
+    ResamplerStats stats() const { return ResamplerStats(); }
+    void reset() {}
+#endif
+};
+
+/**
+   Aggregation of the counters of many resamplers, under labels chosen by
+   the caller, such as a stream or a ratio
+
+   This class is thread-safe.
+ */
+class ResamplerStatsRegistry {
+public:
+    /**
+       Add the counters of a resampler to the total of a label.
+     */
+    void add(const std::string &label, const ResamplerStats &stats);
+
+    /**
+       Get the totals, by label.
+     */
+    std::map<std::string, ResamplerStats> totals() const;
+
+    /**
+       Write the totals as a JSON array, one object per label.
+     */
+    void print(FILE *file) const;
+
+    /**
+       Forget all the totals.
+     */
+    void clear();
+
+private:
+    mutable std::mutex fMutex;
+    std::map<std::string, ResamplerStats> fTotals;
+};